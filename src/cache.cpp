@@ -1,44 +1,62 @@
 #include "cache.h"
+#include "cache_journal.h"
 #include "log.h"
 #include "cfg.h"
+#include "statistics/prometheus/prometheus_exporter.h"
 #include <unistd.h>
+#include <cstdio>
+#include <chrono>
 
 #define RECONNECT_DELAY 5
 
+/* batch entries are passed as arrays and cached by one statement */
 #define CACHE_LNP_SQL \
-    "SELECT * FROM cache_lnp_data($1,$2,$3,$4,$5)"
-
-#define CACHE_LNP_SQL_FMT \
-    "SELECT * FROM cache_lnp_data(%d,'%s','%s','%s','%s')"
+    "SELECT cache_lnp_data(e.database_id,e.dst,e.lrn,e.tag,e.data) " \
+    "FROM unnest($1::smallint[],$2::varchar[],$3::varchar[],$4::varchar[],$5::varchar[]) " \
+    "AS e(database_id,dst,lrn,tag,data)"
 
 #define CACHE_LNP_STMT "cache_lnp"
 
-const char *cache_lnp_args[] = {
-	"smallint",
-	"varchar",
-	"varchar",
-	"varchar",
-    "varchar",
-	NULL
-};
+/* failed batch is dropped after the retry unless spilled to the journal */
+#define CACHE_BATCH_ATTEMPTS 2
 
-_cache::_cache():
+cache_writer::cache_writer(unsigned int index):
+    index(index),
+    q(new queue_t(cfg.db.cache_queue_size)),
+    dropped(0),
     gotostop(false),
-    c(NULL)
-{}
+    c(NULL),
+    last_prune(std::chrono::steady_clock::now()),
+    retained(0),
+    spilled(0),
+    replayed(0)
+{
+	inflight.resize(std::max(cfg.db.cache_pipeline_depth, 1u));
+	for(auto &b: inflight) {
+		b.entries.resize(cfg.db.cache_batch_size);
+		b.count = 0;
+		b.attempts = 0;
+	}
 
-_cache::~_cache() {}
+	if(!cfg.db.cache_journal_dir.empty()) {
+		journal.reset(new cache_journal(cfg.db.cache_journal_dir, index,
+			size_t(cfg.db.cache_journal_segment_size) << 20,
+			cfg.db.cache_journal_max_size / cfg.db.cache_journal_segment_size));
+	}
+}
+
+cache_writer::~cache_writer() {}
 
 #define RECONNECT_DELAY 5
 
-void _cache::prepare_queries(pqxx::connection *conn)
+void cache_writer::prepare_queries(pqxx::connection *conn)
 {
 	conn->set_variable("search_path",cfg.db.schema+", public");
 	conn->prepare(CACHE_LNP_STMT, CACHE_LNP_SQL);
 	conn->prepare_now(CACHE_LNP_STMT);
 }
 
-int _cache::_connect_db(pqxx::connection **conn, string conn_str)
+int cache_writer::_connect_db(pqxx::connection **conn, string conn_str)
 {
 	pqxx::connection *c = NULL;
 	int ret = 0;
@@ -52,6 +70,7 @@ int _cache::_connect_db(pqxx::connection **conn, string conn_str)
 	} catch(const pqxx::broken_connection &e){
 			err("database connection exception: %s",e.what());
 		delete c;
+		c = NULL;
 	} catch(const pqxx::undefined_function &e){
 		err("database exception: undefined_function query: %s, what: %s",e.query().c_str(),e.what());
 		c->disconnect();
@@ -63,27 +82,63 @@ int _cache::_connect_db(pqxx::connection **conn, string conn_str)
 	return ret;
 }
 
-int _cache::connect_db()
+int cache_writer::connect_db()
 {
 	return _connect_db(&c,cfg.db.get_conn_string().c_str());
 }
 
-void _cache::run()
+void cache_writer::run()
 {
-	set_name("db-cache-wr");
+	char name[16];
+	snprintf(name, sizeof(name), "db-cache-wr%u", index);
+	set_name(name);
+
+	bool db_err = false;
+	if(journal)
+		journal->open();
+
 	if(!connect_db()){
-		throw std::logic_error("can't connect to the database");
+		//drivers could be loaded from the file without the database,
+		//entries are queued or spilled to the journal until connected
+		err("can't connect to the database");
+		db_err = true;
 	}
-	bool db_err = false;
+
+	const size_t batch_size = cfg.db.cache_batch_size;
+	const std::chrono::milliseconds check_interval(cfg.db.check_timeout);
+	const std::chrono::seconds reconnect_interval(RECONNECT_DELAY);
+	//the queue is polled, so producers never wait for the writer
+	const unsigned long poll_interval = std::max(cfg.db.cache_flush_interval, 1u);
+
+	auto last_check = std::chrono::steady_clock::now();
+
 	while(true) {
-		bool qrun = q_run.wait_for_to(cfg.db.check_timeout);
+		//wait for the full batch up to the flush interval,
+		//the journal is replayed without delays
+		if(db_err || (q->size() < batch_size && (!journal || journal->empty())))
+			q_run.wait_for_to(poll_interval);
 
 		if(gotostop){
+			if(journal) {
+				//queued entries are written on the next start
+				spill(0);
+				journal->flush();
+			}
 			stopped.set(true);
 			return;
 		}
 
-		if(db_err || !qrun){ //check/renew connection
+		prometheus_exporter::instance()->cache_queue_stats(index,
+			q->size(), dropped.exchange(0));
+		if(journal) {
+			prometheus_exporter::instance()->cache_journal_stats(index,
+				journal->size(), journal->segments_count(), spilled, replayed);
+			spilled = replayed = 0;
+		}
+
+		auto now = std::chrono::steady_clock::now();
+		if(now - last_check >= (db_err ? reconnect_interval : check_interval)){ //check/renew connection
+			last_check = now;
 			if(NULL!=c){
 				try {
 					pqxx::work t(*c);
@@ -109,39 +164,228 @@ void _cache::run()
 		}
 
 		if(db_err) {
-			dbg("wait %d seconds",RECONNECT_DELAY);
-			sleep(RECONNECT_DELAY);
+			//entries are queued up to the queue size meanwhile,
+			//entries over the threshold are spilled to the journal
+			if(journal)
+				spill(cfg.db.cache_journal_threshold);
+			continue;
+		}
+
+		//process queue. up to cache_pipeline_depth batches are sent
+		//at once, batches failed before are retried first
+		size_t batches = retained;
+		while(batches < inflight.size()) {
+			pending_batch &b = inflight[batches];
+			size_t popped = collect_batch(b.entries);
+			if(!popped)
+				break;
+			b.count = skip_unchanged(b.entries, popped);
+			if(b.count) {
+				b.attempts = 0;
+				batches++;
+			}
+		}
+		retained = 0;
+
+		if(journal && !journal->empty()) {
+			//new entries follow the journal to keep the writes order
+			for(size_t i = 0; i < batches; i++) {
+				for(size_t j = 0; j < inflight[i].count; j++)
+					journal_append(inflight[i].entries[j]);
+			}
+			journal->flush();
+
+			if(!replay_journal()) {
+				err("cache journal replay error");
+				db_err = true;
+			} else {
+				last_check = std::chrono::steady_clock::now();
+			}
 			continue;
 		}
 
-		//process queue
-		q_m.lock();
-		if(q.empty()){
-			q_run.set(false);
-			q_m.unlock();
+		if(!batches)
+			continue;
+
+		size_t acked = write_batches(batches);
+		for(size_t i = 0; i < acked; i++) {
+			dbg("%zu entries were written to the database",inflight[i].count);
+			remember_persisted(inflight[i].entries, inflight[i].count);
+		}
+
+		if(acked == batches) {
+			last_check = std::chrono::steady_clock::now();
 			continue;
 		}
 
-		cache_entry *e = q.front();
-		q.pop_front();
+		//failed pipeline is rolled back as a whole
+		for(size_t i = acked; i < batches; i++) {
+			pending_batch &b = inflight[i];
+			if(journal) {
+				err("cache update error. %zu entries are spilled to the journal",b.count);
+				for(size_t j = 0; j < b.count; j++)
+					journal_append(b.entries[j]);
+			} else if(++b.attempts < CACHE_BATCH_ATTEMPTS) {
+				err("cache update error. %zu entries are retained for retry",b.count);
+				std::swap(inflight[retained++], b);
+			} else {
+				err("cache update error. %zu entries are dropped",b.count);
+			}
+		}
+		if(journal)
+			journal->flush();
+		db_err = true;
+	}
+}
+
+void cache_writer::journal_append(const cache_entry &e)
+{
+	if(journal->append(e))
+		spilled++;
+	else
+		dropped++;
+}
+
+/**
+ * @brief Move queued entries over keep count to the journal
+ */
+void cache_writer::spill(size_t keep)
+{
+	static thread_local cache_entry next;
+	size_t count = 0;
+
+	while(q->size() > keep && q->try_pop(next)) {
+		journal_append(next);
+		count++;
+	}
+
+	if(count) {
+		dbg("%zu entries were spilled to the journal",count);
+		journal->flush();
+	}
+}
+
+/**
+ * @brief Write the next cache_journal_replay_batch entries
+ *        from the journal
+ */
+bool cache_writer::replay_journal()
+{
+	size_t count = journal->read(replay, cfg.db.cache_journal_replay_batch);
+	if(!count)
+		return true;
+
+	if(!update_cache(replay, count))
+		return false;
+
+	dbg("%zu entries were replayed from the journal",count);
+	journal->commit();
+	remember_persisted(replay, count);
+	replayed += count;
 
-		if(q.empty())
-			q_run.set(false);
+	if(journal->empty())
+		info("cache journal of writer %u is replayed",index);
 
-		q_m.unlock();
+	return true;
+}
+
+/**
+ * @brief Drain the queue to the batch of up to cache_batch_size
+ *        distinct numbers. Entries for the same (database_id, dst)
+ *        are coalesced keeping the last result
+ *
+ * @return entries count in the batch
+ */
+size_t cache_writer::collect_batch(std::vector<cache_entry> &batch)
+{
+	static thread_local cache_entry next;
+	size_t count = 0, coalesced = 0;
 
-		if(!update_cache(e)){
-			err("cache update error");
-			db_err = true;
-		} else {
-			dbg("entry %d:%s => %s was written to the database",
-				e->database_id,e->dst.c_str(),e->lrn.c_str());
+	batch_index.clear();
+	while(count < batch.size() && q->try_pop(next)) {
+		auto it = batch_index.emplace(entry_key{next.database_id, next.dst}, count);
+		if(!it.second) {
+			//keep the first entry queuing time for the lag
+			next.queued = batch[it.first->second].queued;
+			std::swap(batch[it.first->second], next);
+			coalesced++;
+			continue;
 		}
-		delete e;
+		std::swap(batch[count], next);
+		count++;
 	}
+
+	if(coalesced)
+		prometheus_exporter::instance()->cache_entries_skipped(index, coalesced, 0);
+
+	return count;
+}
+
+size_t cache_writer::result_hash(const cache_entry &e)
+{
+	std::hash<string> h;
+	return h(e.lrn) ^ (h(e.tag) * 31);
 }
 
-void _cache::on_stop()
+/**
+ * @brief Remove entries with lrn and tag unchanged since
+ *        the last write within cache_refresh_interval
+ *
+ * @return entries count left in the batch
+ */
+size_t cache_writer::skip_unchanged(std::vector<cache_entry> &batch, size_t count)
+{
+	if(!cfg.db.cache_refresh_interval)
+		return count;
+
+	auto now = std::chrono::steady_clock::now();
+	const std::chrono::seconds refresh_interval(cfg.db.cache_refresh_interval);
+
+	//forget entries to be refreshed anyway
+	if(now - last_prune >= refresh_interval) {
+		for(auto it = persisted.begin(); it != persisted.end();) {
+			if(now - it->second.time >= refresh_interval)
+				it = persisted.erase(it);
+			else
+				++it;
+		}
+		last_prune = now;
+	}
+
+	size_t left = 0, unchanged = 0;
+	for(size_t i = 0; i < count; i++) {
+		auto it = persisted.find(entry_key{batch[i].database_id, batch[i].dst});
+		if(it != persisted.end() &&
+		   it->second.result_hash == result_hash(batch[i]) &&
+		   now - it->second.time < refresh_interval)
+		{
+			unchanged++;
+			continue;
+		}
+		if(left != i)
+			std::swap(batch[left], batch[i]);
+		left++;
+	}
+
+	if(unchanged)
+		prometheus_exporter::instance()->cache_entries_skipped(index, 0, unchanged);
+
+	return left;
+}
+
+void cache_writer::remember_persisted(const std::vector<cache_entry> &batch, size_t count)
+{
+	if(!cfg.db.cache_refresh_interval)
+		return;
+
+	auto now = std::chrono::steady_clock::now();
+	for(size_t i = 0; i < count; i++) {
+		persisted[entry_key{batch[i].database_id, batch[i].dst}] =
+			persisted_value{result_hash(batch[i]), now};
+	}
+}
+
+void cache_writer::on_stop()
 {
 	gotostop=true;
 	q_run.set(true);
@@ -149,16 +393,68 @@ void _cache::on_stop()
 	if(c) c->disconnect();
 }
 
-void _cache::sync(cache_entry *e)
+/**
+ * @brief Queue entry for writing. Never blocks, the oldest or the new
+ *        entry is dropped on the queue overflow (cache_queue_overflow)
+ */
+void cache_writer::sync(CDriverCfg::CfgUniqId_t database_id, const string &dst,
+                  const CDriver::SResult_t &result)
 {
-	q_m.lock();
-	q.push_back(e);
-	q_m.unlock();
-	q_run.set(true);
+	auto fill = [&](cache_entry &e) { e.assign(database_id, dst, result); };
+
+	bool pushed = q->try_push(fill);
+	if(!pushed && cfg.db.cache_drop_oldest) {
+		static thread_local cache_entry evicted;
+		//writer may pop meanwhile, so a couple of attempts
+		for(int i = 0; !pushed && i < 3; i++) {
+			if(q->try_pop(evicted))
+				dropped++;
+			pushed = q->try_push(fill);
+		}
+	}
+
+	if(!pushed)
+		dropped++;
+}
+
+/**
+ * @brief Append value to PostgreSQL array literal
+ */
+static void array_append(string &out, const string &value)
+{
+	out += out.empty() ? '{' : ',';
+	out += '"';
+	for(char ch: value) {
+		if(ch == '"' || ch == '\\')
+			out += '\\';
+		out += ch;
+	}
+	out += '"';
 }
 
-bool _cache::update_cache(cache_entry *e)
+/* statement parameters of the batch */
+struct cache_arrays {
+	string ids, dsts, lrns, tags, datas;
+
+	cache_arrays(const std::vector<cache_entry> &batch, size_t count)
+	{
+		for(size_t i = 0; i < count; i++) {
+			const cache_entry &e = batch[i];
+			array_append(ids, std::to_string(e.database_id));
+			array_append(dsts, e.dst);
+			array_append(lrns, e.lrn);
+			array_append(tags, e.tag);
+			array_append(datas, e.data);
+		}
+		ids += '}'; dsts += '}'; lrns += '}'; tags += '}'; datas += '}';
+	}
+};
+
+bool cache_writer::update_cache(const std::vector<cache_entry> &batch, size_t count)
 {
+	cache_arrays a(batch, count);
+
+	auto start = std::chrono::steady_clock::now();
 	try {
 		pqxx::nontransaction tnx(*c);
 		if(!tnx.prepared(CACHE_LNP_STMT).exists()){
@@ -167,21 +463,122 @@ bool _cache::update_cache(cache_entry *e)
 		}
 
 		pqxx::prepare::invocation invoc = tnx.prepared(CACHE_LNP_STMT);
-		invoc(e->database_id);
-		invoc(e->dst);
-		invoc(e->lrn);
-        invoc(e->tag);
-		invoc(e->data);
+		invoc(a.ids);
+		invoc(a.dsts);
+		invoc(a.lrns);
+		invoc(a.tags);
+		invoc(a.datas);
 
 		invoc.exec();
 
+		auto now = std::chrono::steady_clock::now();
+		std::chrono::duration<double, std::milli> elapsed = now - start;
+		//the oldest entry of the batch is queued first
+		std::chrono::duration<double, std::milli> lag = now - batch[0].queued;
+		prometheus_exporter::instance()->cache_batch_committed(index,
+			count, true, elapsed.count(), lag.count());
+
 		return true;
 	} catch(const pqxx::pqxx_exception &exc){
 		dbg("cache update SQL exception: %s",exc.base().what());
-		dbg("query: " CACHE_LNP_SQL_FMT,
-            e->database_id,e->dst.c_str(),e->lrn.c_str(),
-            e->tag.c_str(),e->data.c_str());
+		dbg("batch of %zu entries. first: %d:%s => %s",
+			count, batch[0].database_id,
+			batch[0].dst.c_str(), batch[0].lrn.c_str());
 		c->disconnect();
 	}
+
+	prometheus_exporter::instance()->cache_batch_committed(index, count, false, 0, 0);
 	return false;
 }
+
+/**
+ * @brief Write first count batches of inflight by the pipeline,
+ *        so they take one round trip to the database
+ *
+ * @note pipeline sends the queries as one multi-statement query, which
+ *       the server runs as one implicit transaction. so the failure
+ *       of any batch rolls back the batches before it as well
+ *
+ * @return count of the acknowledged batches: either all or none
+ */
+size_t cache_writer::write_batches(size_t count)
+{
+	if(count == 1)
+		return update_cache(inflight[0].entries, inflight[0].count) ? 1 : 0;
+
+	size_t retrieved = 0;
+	auto start = std::chrono::steady_clock::now();
+	try {
+		pqxx::nontransaction tnx(*c);
+		pqxx::pipeline p(tnx);
+		std::vector<pqxx::pipeline::query_id> ids(count);
+
+		//hold the queries to send them at once
+		p.retain(count);
+		for(size_t i = 0; i < count; i++) {
+			cache_arrays a(inflight[i].entries, inflight[i].count);
+			ids[i] = p.insert("EXECUTE " CACHE_LNP_STMT "(" +
+				tnx.quote(a.ids) + "," + tnx.quote(a.dsts) + "," +
+				tnx.quote(a.lrns) + "," + tnx.quote(a.tags) + "," +
+				tnx.quote(a.datas) + ")");
+		}
+		p.resume();
+
+		for(; retrieved < count; retrieved++)
+			p.retrieve(ids[retrieved]);
+
+		//committed at once with the last batch
+		auto now = std::chrono::steady_clock::now();
+		std::chrono::duration<double, std::milli> elapsed = now - start;
+		for(size_t i = 0; i < count; i++) {
+			const pending_batch &b = inflight[i];
+			std::chrono::duration<double, std::milli> lag = now - b.entries[0].queued;
+			prometheus_exporter::instance()->cache_batch_committed(index,
+				b.count, true, elapsed.count(), lag.count());
+		}
+
+		return count;
+	} catch(const pqxx::pqxx_exception &exc){
+		dbg("cache pipeline SQL exception: %s",exc.base().what());
+		const pending_batch &b = inflight[std::min(retrieved, count - 1)];
+		dbg("batch %zu of %zu failed, all batches are rolled back. first: %d:%s => %s",
+			retrieved + 1, count, b.entries[0].database_id,
+			b.entries[0].dst.c_str(), b.entries[0].lrn.c_str());
+		c->disconnect();
+	}
+
+	for(size_t i = 0; i < count; i++)
+		prometheus_exporter::instance()->cache_batch_committed(index,
+			inflight[i].count, false, 0, 0);
+
+	return 0;
+}
+
+_cache::_cache()
+{
+	for(unsigned int i = 0; i < cfg.db.cache_writers; i++)
+		writers.emplace_back(new cache_writer(i));
+}
+
+_cache::~_cache() {}
+
+void _cache::start()
+{
+	for(auto &w: writers)
+		w->start();
+}
+
+void _cache::stop()
+{
+	for(auto &w: writers)
+		w->stop();
+}
+
+void _cache::sync(CDriverCfg::CfgUniqId_t database_id, const string &dst,
+                  const CDriver::SResult_t &result)
+{
+	size_t shard = 0;
+	if(writers.size() > 1)
+		shard = (std::hash<string>()(dst) ^ database_id) % writers.size();
+	writers[shard]->sync(database_id, dst, result);
+}
@@ -2,10 +2,16 @@
 
 #include "thread.h"
 #include "singleton.h"
+#include "ring_queue.h"
+#include "cache_journal.h"
 
 #include <string>
-#include <list>
 #include <utility>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <unordered_map>
+#include <memory>
 
 #include <pqxx/pqxx>
 
@@ -18,29 +24,83 @@ using std::pair;
 struct cache_entry {
     CDriverCfg::CfgUniqId_t database_id;
     string dst,lrn, data, tag;
-    cache_entry(CDriverCfg::CfgUniqId_t _database_id, const string &_dst, const CDriver::SResult_t & r):
-		database_id(_database_id),
-		dst(_dst),
-        lrn(r.localRoutingNumber),
-        data(r.rawData),
-        tag(r.localRoutingTag) {}
+    std::chrono::steady_clock::time_point queued;
+
+    cache_entry(): database_id(0) {}
+
+    /* reuses strings capacity */
+    void assign(CDriverCfg::CfgUniqId_t _database_id, const string &_dst, const CDriver::SResult_t & r)
+    {
+        database_id = _database_id;
+        dst = _dst;
+        lrn = r.localRoutingNumber;
+        data = r.rawData;
+        tag = r.localRoutingTag;
+        queued = std::chrono::steady_clock::now();
+    }
 };
 
-class _cache: public thread {
-	typedef std::list<cache_entry *> queue_t;
-	queue_t q;
-	mutex q_m;
+/* writes entries of one shard by its own connection */
+class cache_writer: public ::thread {
+	typedef ring_queue<cache_entry> queue_t;
+	const unsigned int index;
+	std::unique_ptr<queue_t> q;
+	std::atomic<unsigned long> dropped;
+
 	condition<bool> q_run;
 	condition<bool> stopped;
 	bool gotostop;
 
 	pqxx::connection *c;
 
+	//writer thread state for coalescing and change detection
+	struct entry_key {
+		CDriverCfg::CfgUniqId_t database_id;
+		string dst;
+		bool operator==(const entry_key &k) const {
+			return database_id == k.database_id && dst == k.dst;
+		}
+	};
+	struct entry_key_hash {
+		size_t operator()(const entry_key &k) const {
+			return std::hash<string>()(k.dst) ^ (size_t(k.database_id) * 0x9e3779b97f4a7c15ULL);
+		}
+	};
+	struct persisted_value {
+		size_t result_hash; //lrn and tag
+		std::chrono::steady_clock::time_point time;
+	};
+	std::unordered_map<entry_key, size_t, entry_key_hash> batch_index;
+	std::unordered_map<entry_key, persisted_value, entry_key_hash> persisted;
+	std::chrono::steady_clock::time_point last_prune;
+
+	//batches sent by one round trip, failed ones are kept for retry
+	struct pending_batch {
+		std::vector<cache_entry> entries;
+		size_t count;
+		unsigned int attempts;
+	};
+	std::vector<pending_batch> inflight;
+	size_t retained;
+
+	//entries spill while the database is unavailable
+	std::unique_ptr<cache_journal> journal;
+	std::vector<cache_entry> replay;
+	unsigned long spilled, replayed;
+
 	void prepare_queries(pqxx::connection *conn);
 	int _connect_db(pqxx::connection **conn, string conn_str);
 	int connect_db();
 
-	bool update_cache(cache_entry *e);
+	size_t collect_batch(std::vector<cache_entry> &batch);
+	size_t skip_unchanged(std::vector<cache_entry> &batch, size_t count);
+	void remember_persisted(const std::vector<cache_entry> &batch, size_t count);
+	static size_t result_hash(const cache_entry &e);
+	void journal_append(const cache_entry &e);
+	void spill(size_t keep);
+	bool replay_journal();
+	bool update_cache(const std::vector<cache_entry> &batch, size_t count);
+	size_t write_batches(size_t count);
 
   protected:
 	void on_stop();
@@ -48,11 +108,26 @@ class _cache: public thread {
 
   public:
 	void run();
-	void sync(cache_entry *e);
+	void sync(CDriverCfg::CfgUniqId_t database_id, const string &dst,
+	          const CDriver::SResult_t &result);
+
+	explicit cache_writer(unsigned int index);
+	~cache_writer();
+};
+
+/* shards entries between writers by the number so the writes
+ * of the same number are ordered */
+class _cache {
+	std::vector<std::unique_ptr<cache_writer>> writers;
+
+  public:
+	void start();
+	void stop();
+	void sync(CDriverCfg::CfgUniqId_t database_id, const string &dst,
+	          const CDriver::SResult_t &result);
 
 	_cache();
 	~_cache();
 };
 
 typedef singleton<_cache> lnp_cache;
-
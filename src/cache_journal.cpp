@@ -0,0 +1,372 @@
+#include "cache_journal.h"
+#include "cache.h"
+#include "log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/mman.h>
+
+#include <zlib.h>
+
+#define JOURNAL_MAGIC "YLNPJRN1"
+#define JOURNAL_VERSION 1
+
+namespace {
+
+struct journal_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t header_size;
+	uint64_t seq;
+	uint64_t read_offset;
+};
+
+const size_t header_size = 64;
+static_assert(sizeof(journal_header) <= header_size, "journal header size");
+
+//record: size, crc32 of the payload, payload
+struct record_header {
+	uint32_t size;
+	uint32_t crc;
+};
+
+//payload: queued time, database_id, strings lengths, strings
+struct record_fields {
+	int64_t queued_ms;
+	int32_t database_id;
+	uint32_t dst_len, lrn_len, tag_len, data_len;
+};
+
+int64_t system_ms()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+}
+
+cache_journal::cache_journal(const string &dir, unsigned int writer,
+                             size_t segment_size, size_t max_segments):
+	dir(dir),
+	writer(writer),
+	segment_size(segment_size),
+	max_segments(std::max(max_segments, size_t(1))),
+	next_seq(0),
+	pending(0),
+	read_end(0),
+	read_count(0)
+{}
+
+cache_journal::~cache_journal()
+{
+	flush();
+	for(auto &s: segments)
+		unmap(s);
+}
+
+string cache_journal::segment_path(uint64_t seq) const
+{
+	char name[64];
+	snprintf(name, sizeof(name), "/cache-%u-%020llu.journal",
+		writer, (unsigned long long)seq);
+	return dir + name;
+}
+
+uint64_t &cache_journal::read_offset(segment &s)
+{
+	return reinterpret_cast<journal_header *>(s.data)->read_offset;
+}
+
+void cache_journal::unmap(segment &s)
+{
+	if(s.data) munmap(s.data, s.size);
+	s.data = NULL;
+}
+
+void cache_journal::open()
+{
+	DIR *d = opendir(dir.c_str());
+	if(!d) {
+		err("can't open cache journal directory '%s': %s", dir.c_str(), strerror(errno));
+		return;
+	}
+
+	std::vector<uint64_t> seqs;
+	while(struct dirent *e = readdir(d)) {
+		unsigned int w;
+		unsigned long long seq;
+		int n = 0;
+		if(sscanf(e->d_name, "cache-%u-%llu.journal%n", &w, &seq, &n) == 2 &&
+		   e->d_name[n] == '\0' && w == writer)
+		{
+			seqs.push_back(seq);
+		}
+	}
+	closedir(d);
+
+	std::sort(seqs.begin(), seqs.end());
+	for(uint64_t seq: seqs) {
+		segment s{seq, segment_path(seq), NULL, 0, 0, 0, true};
+		next_seq = seq + 1;
+		if(!open_segment(s))
+			continue;
+
+		if(!s.pending) {
+			unmap(s);
+			unlink(s.path.c_str());
+			continue;
+		}
+
+		pending += s.pending;
+		segments.push_back(s);
+	}
+
+	if(pending)
+		info("cache journal of writer %u: %zu entries in %zu segments to replay",
+			writer, pending, segments.size());
+}
+
+bool cache_journal::open_segment(segment &s)
+{
+	int fd = ::open(s.path.c_str(), O_RDWR);
+	if(fd < 0) {
+		err("can't open cache journal '%s': %s", s.path.c_str(), strerror(errno));
+		return false;
+	}
+
+	off_t size = lseek(fd, 0, SEEK_END);
+	if(size < (off_t)header_size) {
+		err("cache journal '%s' is truncated", s.path.c_str());
+		::close(fd);
+		return false;
+	}
+
+	void *data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if(data == MAP_FAILED) {
+		err("can't map cache journal '%s': %s", s.path.c_str(), strerror(errno));
+		return false;
+	}
+
+	s.data = static_cast<char *>(data);
+	s.size = size;
+
+	const journal_header *h = reinterpret_cast<const journal_header *>(s.data);
+	if(memcmp(h->magic, JOURNAL_MAGIC, sizeof(h->magic)) ||
+	   h->version != JOURNAL_VERSION || h->header_size != header_size)
+	{
+		err("unexpected cache journal '%s' header", s.path.c_str());
+		unmap(s);
+		return false;
+	}
+
+	size_t off = header_size;
+	while(off + sizeof(record_header) <= s.size) {
+		record_header r;
+		memcpy(&r, s.data + off, sizeof(r));
+		if(!r.size)
+			break;
+
+		size_t next = off + sizeof(r) + r.size;
+		if(r.size < sizeof(record_fields) || next > s.size ||
+		   r.crc != crc32(0, reinterpret_cast<const Bytef *>(s.data + off + sizeof(r)), r.size))
+		{
+			err("cache journal '%s' is broken at %zu, the rest is skipped",
+				s.path.c_str(), off);
+			break;
+		}
+
+		if(off >= h->read_offset)
+			s.pending++;
+		off = next;
+	}
+	s.end = off;
+
+	return true;
+}
+
+bool cache_journal::create_segment()
+{
+	segment s{next_seq, segment_path(next_seq), NULL, segment_size, header_size, 0, false};
+
+	int fd = ::open(s.path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+	if(fd < 0) {
+		err("can't create cache journal '%s': %s", s.path.c_str(), strerror(errno));
+		return false;
+	}
+
+	//reserve the space, writing to the mapped hole on the full disk is SIGBUS
+	int ret = posix_fallocate(fd, 0, s.size);
+	if(ret) {
+		err("can't allocate %zu bytes for cache journal '%s': %s",
+			s.size, s.path.c_str(), strerror(ret));
+		::close(fd);
+		unlink(s.path.c_str());
+		return false;
+	}
+
+	void *data = mmap(NULL, s.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if(data == MAP_FAILED) {
+		err("can't map cache journal '%s': %s", s.path.c_str(), strerror(errno));
+		unlink(s.path.c_str());
+		return false;
+	}
+	s.data = static_cast<char *>(data);
+
+	journal_header *h = reinterpret_cast<journal_header *>(s.data);
+	memcpy(h->magic, JOURNAL_MAGIC, sizeof(h->magic));
+	h->version = JOURNAL_VERSION;
+	h->header_size = header_size;
+	h->seq = s.seq;
+	h->read_offset = header_size;
+
+	next_seq++;
+	segments.push_back(s);
+	dbg("cache journal segment '%s' is created", s.path.c_str());
+
+	return true;
+}
+
+void cache_journal::remove_front()
+{
+	segment &s = segments.front();
+	unmap(s);
+	if(unlink(s.path.c_str()))
+		err("can't remove cache journal '%s': %s", s.path.c_str(), strerror(errno));
+	segments.pop_front();
+}
+
+bool cache_journal::append(const cache_entry &e)
+{
+	record_fields f;
+	f.queued_ms = system_ms() - std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::steady_clock::now() - e.queued).count();
+	f.database_id = e.database_id;
+	f.dst_len = e.dst.size();
+	f.lrn_len = e.lrn.size();
+	f.tag_len = e.tag.size();
+	f.data_len = e.data.size();
+
+	const size_t payload = sizeof(f) + f.dst_len + f.lrn_len + f.tag_len + f.data_len;
+	const size_t need = sizeof(record_header) + payload;
+	if(need > segment_size - header_size)
+		return false;
+
+	if(segments.empty() || segments.back().sealed ||
+	   segments.back().end + need > segments.back().size)
+	{
+		if(!segments.empty() && !segments.back().sealed) {
+			segment &s = segments.back();
+			s.sealed = true;
+			msync(s.data, s.size, MS_SYNC);
+			//replayed completely while it was appended
+			if(segments.size() == 1 && !s.pending)
+				remove_front();
+		}
+		if(segments.size() >= max_segments || !create_segment())
+			return false;
+	}
+
+	segment &s = segments.back();
+	char *p = s.data + s.end + sizeof(record_header);
+	char *payload_start = p;
+	memcpy(p, &f, sizeof(f)); p += sizeof(f);
+	memcpy(p, e.dst.data(), f.dst_len); p += f.dst_len;
+	memcpy(p, e.lrn.data(), f.lrn_len); p += f.lrn_len;
+	memcpy(p, e.tag.data(), f.tag_len); p += f.tag_len;
+	memcpy(p, e.data.data(), f.data_len);
+
+	record_header r;
+	r.size = payload;
+	r.crc = crc32(0, reinterpret_cast<const Bytef *>(payload_start), payload);
+	memcpy(s.data + s.end, &r, sizeof(r));
+
+	s.end += need;
+	s.pending++;
+	pending++;
+
+	return true;
+}
+
+void cache_journal::flush()
+{
+	if(segments.empty())
+		return;
+
+	//replay position of the first and records of the last segment,
+	//only dirty pages are written
+	msync(segments.front().data, header_size, MS_SYNC);
+	if(!segments.back().sealed)
+		msync(segments.back().data, segments.back().size, MS_SYNC);
+}
+
+size_t cache_journal::read(std::vector<cache_entry> &batch, size_t max)
+{
+	read_count = 0;
+
+	while(!segments.empty()) {
+		segment &s = segments.front();
+		size_t off = read_offset(s);
+		if(off < s.end)
+			break;
+		if(!s.sealed)
+			return 0;
+		remove_front();
+	}
+
+	if(segments.empty())
+		return 0;
+
+	if(batch.size() < max)
+		batch.resize(max);
+
+	segment &s = segments.front();
+	size_t off = read_offset(s);
+	const int64_t now_ms = system_ms();
+	const auto now = std::chrono::steady_clock::now();
+
+	while(read_count < max && off < s.end) {
+		record_header r;
+		memcpy(&r, s.data + off, sizeof(r));
+		const char *p = s.data + off + sizeof(r);
+
+		record_fields f;
+		memcpy(&f, p, sizeof(f));
+		p += sizeof(f);
+
+		cache_entry &e = batch[read_count++];
+		e.database_id = f.database_id;
+		e.dst.assign(p, f.dst_len); p += f.dst_len;
+		e.lrn.assign(p, f.lrn_len); p += f.lrn_len;
+		e.tag.assign(p, f.tag_len); p += f.tag_len;
+		e.data.assign(p, f.data_len);
+		e.queued = now - std::chrono::milliseconds(std::max(now_ms - f.queued_ms, int64_t(0)));
+
+		off += sizeof(r) + r.size;
+	}
+	read_end = off;
+
+	return read_count;
+}
+
+void cache_journal::commit()
+{
+	if(!read_count || segments.empty())
+		return;
+
+	segment &s = segments.front();
+	read_offset(s) = read_end;
+	s.pending -= read_count;
+	pending -= read_count;
+	read_count = 0;
+
+	if(s.sealed && read_end >= s.end)
+		remove_front();
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <string>
+#include <deque>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+using std::string;
+
+struct cache_entry;
+
+/**
+ * @brief Append-only journal of the cache entries not written
+ *        to the database
+ *
+ * @note Journal is the sequence of preallocated segment files
+ *       <dir>/cache-<writer>-<seq>.journal mapped to the memory.
+ *       Every record is protected by CRC32, so the torn tail after
+ *       the crash is detected and skipped on replay. The replay
+ *       position is kept in the segment header and the segment is
+ *       removed once it is replayed completely. Segments left by
+ *       the previous run are replayed and never appended.
+ *       Records and the replay position are on the disk once flush()
+ *       returns (synchronous msync), the ones appended after the last
+ *       flush() could be lost on the host crash. Segments are readable
+ *       by the owner only
+ */
+class cache_journal {
+	struct segment {
+		uint64_t seq;
+		string path;
+		char *data;
+		size_t size;
+		size_t end;       //valid records end (append position)
+		size_t pending;   //records after the replay position
+		bool sealed;
+	};
+
+	const string dir;
+	const unsigned int writer;
+	const size_t segment_size;
+	const size_t max_segments;
+
+	std::deque<segment> segments;
+	uint64_t next_seq;
+	size_t pending;
+
+	//last read() result to be committed
+	size_t read_end;
+	size_t read_count;
+
+	string segment_path(uint64_t seq) const;
+	bool open_segment(segment &s);
+	bool create_segment();
+	void remove_front();
+	static void unmap(segment &s);
+	static uint64_t &read_offset(segment &s);
+
+  public:
+	cache_journal(const string &dir, unsigned int writer,
+	              size_t segment_size, size_t max_segments);
+	~cache_journal();
+
+	cache_journal(const cache_journal &) = delete;
+	cache_journal &operator=(const cache_journal &) = delete;
+
+	/* loads segments of the previous run */
+	void open();
+
+	bool append(const cache_entry &e);
+	void flush();
+
+	/* reads up to max entries following the replay position */
+	size_t read(std::vector<cache_entry> &batch, size_t max);
+	/* moves the replay position after the last read entries */
+	void commit();
+
+	bool empty() const { return !pending; }
+	size_t size() const { return pending; }
+	size_t segments_count() const { return segments.size(); }
+};
@@ -13,6 +13,22 @@ struct global_cfg_t {
 	struct db_cfg {
 		string host,user,pass,database,schema;
 		unsigned int port, timeout, check_timeout;
+		unsigned int cache_batch_size, cache_flush_interval;
+		unsigned int cache_queue_size;
+		unsigned int cache_refresh_interval;
+		unsigned int cache_writers;
+		unsigned int cache_pipeline_depth;
+		unsigned int cache_fallback_connections, cache_fallback_timeout;
+		string cache_fallback_query;
+		string drivers_config_file;
+		bool drivers_config_from_file;
+		unsigned int drivers_load_threads;
+		string drivers_notify_channel;
+		string cache_journal_dir;
+		unsigned int cache_journal_threshold;
+		unsigned int cache_journal_segment_size, cache_journal_max_size;
+		unsigned int cache_journal_replay_batch;
+		bool cache_drop_oldest;
 		string get_conn_string();
 	} db;
 
@@ -20,6 +36,13 @@ struct global_cfg_t {
 		string contact, from_uri, from_name;
 	} sip;
 
+	struct http_cfg {
+		bool multiplexing;
+		unsigned int max_host_connections, max_total_connections;
+		unsigned int max_cached_connections, max_concurrent_streams;
+		int dns_cache_timeout;
+	} http;
+
 	struct prometheus_cfg {
 		string host;
 		unsigned int port;
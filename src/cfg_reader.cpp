@@ -28,6 +28,26 @@ cfg_opt_t lnp_section_db_opts[] = {
 	CFG_INT("conn_timeout",0,CFGF_NODEFAULT),
 	CFG_INT("check_interval",0,CFGF_NODEFAULT),
 	CFG_STR("schema",nullptr,CFGF_NODEFAULT),
+	CFG_INT("cache_batch_size",100,CFGF_NONE),
+	CFG_INT("cache_flush_interval",100,CFGF_NONE),
+	CFG_INT("cache_queue_size",65536,CFGF_NONE),
+	CFG_STR("cache_queue_overflow","drop_oldest",CFGF_NONE),
+	CFG_INT("cache_refresh_interval",60,CFGF_NONE),
+	CFG_INT("cache_writers",1,CFGF_NONE),
+	CFG_INT("cache_pipeline_depth",4,CFGF_NONE),
+	CFG_INT("cache_fallback_connections",0,CFGF_NONE),
+	CFG_INT("cache_fallback_timeout",50,CFGF_NONE),
+	CFG_STR("drivers_config_file","",CFGF_NONE),
+	CFG_STR("drivers_config_source","database",CFGF_NONE),
+	CFG_INT("drivers_load_threads",4,CFGF_NONE),
+	CFG_STR("drivers_notify_channel","",CFGF_NONE),
+	CFG_STR("cache_fallback_query",
+		"SELECT lrn, tag FROM lnp_cache WHERE database_id = $1 AND dst = $2 LIMIT 1",CFGF_NONE),
+	CFG_STR("cache_journal_dir","",CFGF_NONE),
+	CFG_INT("cache_journal_threshold",16384,CFGF_NONE),
+	CFG_INT("cache_journal_segment_size",64,CFGF_NONE),
+	CFG_INT("cache_journal_max_size",1024,CFGF_NONE),
+	CFG_INT("cache_journal_replay_batch",5000,CFGF_NONE),
 	CFG_END()
 };
 
@@ -38,6 +58,16 @@ cfg_opt_t lnp_section_sip_opts[] = {
 	CFG_END()
 };
 
+cfg_opt_t http_section_opts[] = {
+	CFG_BOOL("multiplexing",cfg_true,CFGF_NONE),
+	CFG_INT("max_host_connections",0,CFGF_NONE),
+	CFG_INT("max_total_connections",0,CFGF_NONE),
+	CFG_INT("max_cached_connections",0,CFGF_NONE),
+	CFG_INT("max_concurrent_streams",0,CFGF_NONE),
+	CFG_INT("dns_cache_timeout",60,CFGF_NONE),
+	CFG_END()
+};
+
 cfg_opt_t prometheus_section_opts[] = {
 	CFG_INT("port",9091,CFGF_NONE),
 	CFG_STR("host","127.0.0.1",CFGF_NONE),
@@ -50,10 +80,32 @@ cfg_opt_t opts[] = {
 	CFG_SEC("daemon",daemon_section_opts,CFGF_NONE),
 	CFG_SEC("db",lnp_section_db_opts,CFGF_NONE),
 	CFG_SEC("sip",lnp_section_sip_opts,CFGF_NONE),
+	CFG_SEC("http",http_section_opts,CFGF_NONE),
 	CFG_SEC("prometheus",prometheus_section_opts,CFGF_NONE),
 	CFG_END()
 };
 
+/* options stored to the unsigned fields, checked before the conversion */
+static int validate_positive(cfg_t *c, cfg_opt_t *opt)
+{
+	long value = cfg_opt_getnint(opt, cfg_opt_size(opt) - 1);
+	if(value <= 0) {
+		cfg_error(c, "option '%s' must be positive, got %ld", opt->name, value);
+		return -1;
+	}
+	return 0;
+}
+
+static const char *positive_opts[] = {
+	"db|cache_batch_size",
+	"db|cache_queue_size",
+	"db|cache_writers",
+	"db|cache_journal_segment_size",
+	"db|cache_journal_replay_batch",
+	"db|cache_pipeline_depth",
+	"db|drivers_load_threads",
+};
+
 #define LOG_BUF_SIZE 2048
 void cfg_reader_error(cfg_t *c, const char *fmt, va_list ap)
 {
@@ -70,6 +122,8 @@ bool load_cfg(const char *path)
 	//remote_cfg_reader r;
 	cfg_t *c = cfg_init(opts, CFGF_NONE);
 	cfg_set_error_function(c,cfg_reader_error);
+	for(auto name: positive_opts)
+		cfg_set_validate_func(c, name, validate_positive);
 
 	switch(cfg_parse(c, path)) {
 	case CFG_SUCCESS:
@@ -106,6 +160,54 @@ bool load_cfg(const char *path)
 
 		cfg.db.timeout = cfg_getint(s, "conn_timeout");
 		cfg.db.check_timeout = cfg_getint(s, "check_interval");
+
+		cfg.db.cache_batch_size = cfg_getint(s, "cache_batch_size");
+		cfg.db.cache_flush_interval = cfg_getint(s, "cache_flush_interval");
+
+		cfg.db.cache_queue_size = cfg_getint(s, "cache_queue_size");
+
+		string overflow = cfg_getstr(s, "cache_queue_overflow");
+		if(overflow == "drop_oldest") {
+			cfg.db.cache_drop_oldest = true;
+		} else if(overflow == "drop_newest") {
+			cfg.db.cache_drop_oldest = false;
+		} else {
+			err("unexpected cache_queue_overflow value '%s'. "
+				"expected: drop_oldest, drop_newest", overflow.c_str());
+			goto out;
+		}
+
+		cfg.db.cache_refresh_interval = cfg_getint(s, "cache_refresh_interval");
+		cfg.db.cache_writers = cfg_getint(s, "cache_writers");
+		cfg.db.cache_pipeline_depth = cfg_getint(s, "cache_pipeline_depth");
+
+		cfg.db.cache_fallback_connections = cfg_getint(s, "cache_fallback_connections");
+		cfg.db.cache_fallback_timeout = cfg_getint(s, "cache_fallback_timeout");
+		cfg.db.cache_fallback_query = cfg_getstr(s, "cache_fallback_query");
+
+		cfg.db.drivers_config_file = cfg_getstr(s, "drivers_config_file");
+		string drivers_source = cfg_getstr(s, "drivers_config_source");
+		if(drivers_source == "database") {
+			cfg.db.drivers_config_from_file = false;
+		} else if(drivers_source == "file") {
+			cfg.db.drivers_config_from_file = true;
+			if(cfg.db.drivers_config_file.empty()) {
+				err("drivers_config_file is required for drivers_config_source 'file'");
+				goto out;
+			}
+		} else {
+			err("unexpected drivers_config_source value '%s'. "
+				"expected: database, file", drivers_source.c_str());
+			goto out;
+		}
+		cfg.db.drivers_load_threads = cfg_getint(s, "drivers_load_threads");
+		cfg.db.drivers_notify_channel = cfg_getstr(s, "drivers_notify_channel");
+
+		cfg.db.cache_journal_dir = cfg_getstr(s, "cache_journal_dir");
+		cfg.db.cache_journal_threshold = cfg_getint(s, "cache_journal_threshold");
+		cfg.db.cache_journal_segment_size = cfg_getint(s, "cache_journal_segment_size");
+		cfg.db.cache_journal_max_size = cfg_getint(s, "cache_journal_max_size");
+		cfg.db.cache_journal_replay_batch = cfg_getint(s, "cache_journal_replay_batch");
 	}
 
 	with_section("sip") {
@@ -113,7 +215,16 @@ bool load_cfg(const char *path)
 		cfg.sip.from_uri = cfg_getstr(s, "from_uri");
 		cfg.sip.from_name = cfg_getstr(s, "from_name");
 	}
-	
+
+	with_section("http") {
+		cfg.http.multiplexing = cfg_getbool(s, "multiplexing");
+		cfg.http.max_host_connections = cfg_getint(s, "max_host_connections");
+		cfg.http.max_total_connections = cfg_getint(s, "max_total_connections");
+		cfg.http.max_cached_connections = cfg_getint(s, "max_cached_connections");
+		cfg.http.max_concurrent_streams = cfg_getint(s, "max_concurrent_streams");
+		cfg.http.dns_cache_timeout = cfg_getint(s, "dns_cache_timeout");
+	}
+
 	with_section("prometheus") {
 		cfg.prometheus.host = cfg_getstr(s, "host");
 		cfg.prometheus.port = cfg_getint(s, "port");
@@ -0,0 +1,77 @@
+#include "FileWatcher.h"
+#include "log.h"
+
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <errno.h>
+#include <cstring>
+
+FileWatcher::FileWatcher(const std::string &path, std::function<void ()> callback)
+    : EventHandler(),
+      on_change(callback) {
+    init_watcher(path);
+}
+
+FileWatcher::~FileWatcher() {
+    if (inotify_fd >= 0) {
+        unlink(inotify_fd);
+        close(inotify_fd);
+    }
+}
+
+int FileWatcher::init_watcher(const std::string &path) {
+    std::string dir;
+    auto pos = path.rfind('/');
+
+    if (pos == std::string::npos) {
+        dir = ".";
+        file_name = path;
+    } else {
+        dir = pos ? path.substr(0, pos) : "/";
+        file_name = path.substr(pos + 1);
+    }
+
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd < 0) {
+        err("inotify_init1 failed: %s", strerror(errno));
+        return -1;
+    }
+
+    /* only replacement by rename: the file could be mapped by the reader,
+     * so the in-place rewrite is not supported (SIGBUS on truncation) */
+    watch_fd = inotify_add_watch(inotify_fd, dir.c_str(), IN_MOVED_TO);
+    if (watch_fd < 0) {
+        err("inotify_add_watch failed for '%s': %s", dir.c_str(), strerror(errno));
+        close(inotify_fd);
+        inotify_fd = -1;
+        return -1;
+    }
+
+    link(inotify_fd, EPOLLIN);
+
+    return inotify_fd;
+}
+
+/* EventHandler overrides */
+
+int FileWatcher::handle_event(int fd, uint32_t, bool &) {
+    alignas(struct inotify_event) char buf[4096];
+    bool changed = false;
+    ssize_t len;
+
+    while ((len = read(fd, buf, sizeof(buf))) > 0) {
+        for (char *p = buf; p < buf + len; ) {
+            auto event = reinterpret_cast<struct inotify_event *>(p);
+            if (event->len && file_name == event->name)
+                changed = true;
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+
+    /* several events of one batch are reported once */
+    if (changed && on_change)
+        on_change();
+
+    return 0;
+}
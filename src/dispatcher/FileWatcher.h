@@ -0,0 +1,27 @@
+#pragma once
+
+#include "dispatcher/EventHandler.h"
+
+#include <string>
+#include <functional>
+
+/**
+ * Calls back when the file is replaced by rename (in-place writes are ignored).
+ * Parent directory is watched, so the file could be absent at the start
+ */
+class FileWatcher: public EventHandler
+{
+    public:
+        FileWatcher(const std::string &path, std::function<void ()> callback);
+        virtual ~FileWatcher();
+        bool is_watching() const { return watch_fd >= 0; }
+        /* EventHandler overrides */
+        int handle_event(int fd, uint32_t events, bool &stop) override;
+
+    private:
+        int init_watcher(const std::string &path);
+        int inotify_fd = -1;
+        int watch_fd = -1;
+        std::string file_name;
+        std::function<void ()> on_change;
+};
@@ -0,0 +1,47 @@
+#include "Notifier.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+Notifier::Notifier(std::function<void ()> callback)
+    : EventHandler(),
+      on_notify(callback) {
+    init_event();
+}
+
+Notifier::~Notifier() {
+    if (event_fd >= 0) {
+        unlink(event_fd);
+        close(event_fd);
+    }
+}
+
+int Notifier::init_event() {
+    event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (event_fd >= 0)
+        link(event_fd, EPOLLIN);
+
+    return event_fd;
+}
+
+int Notifier::notify() {
+    if (event_fd < 0)
+        return -1;
+
+    return eventfd_write(event_fd, 1);
+}
+
+/* EventHandler overrides */
+
+int Notifier::handle_event(int fd, uint32_t, bool &) {
+    eventfd_t value;
+    if (eventfd_read(fd, &value) != 0)
+        return -1;
+
+    if (on_notify)
+        on_notify();
+
+    return 0;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "dispatcher/EventHandler.h"
+
+#include <functional>
+
+/**
+ * Calls back on the dispatcher thread after notify().
+ * notify() could be called from any thread or from the signal handler,
+ * notifications before the callback are collapsed to the one call
+ */
+class Notifier: public EventHandler
+{
+    public:
+        Notifier(std::function<void ()> callback);
+        virtual ~Notifier();
+        int notify();
+        /* EventHandler overrides */
+        int handle_event(int fd, uint32_t events, bool &stop) override;
+
+    private:
+        int init_event();
+        int event_fd = -1;
+        std::function<void ()> on_notify;
+};
@@ -0,0 +1,71 @@
+#include "Timer.h"
+
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <cstring>
+
+Timer::Timer(std::function<void ()> callback)
+    : EventHandler(),
+      on_timer(callback) {
+    init_timer();
+}
+
+Timer::~Timer() {
+    if (timer_fd >= 0) {
+        unlink(timer_fd);
+        close(timer_fd);
+    }
+}
+
+int Timer::init_timer() {
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+    if (timer_fd >= 0)
+        link(timer_fd, EPOLLIN);
+
+    return timer_fd;
+}
+
+int Timer::start(long timeout_ms, bool periodic) {
+    if (timer_fd < 0 || timeout_ms < 0)
+        return -1;
+
+    struct itimerspec its;
+    memset(&its, 0, sizeof(struct itimerspec));
+
+    its.it_value.tv_sec = timeout_ms / 1000;
+    its.it_value.tv_nsec = (timeout_ms % 1000) * 1000 * 1000;
+
+    /* zero it_value disarms the timer, fire in 1 ns instead */
+    if (timeout_ms == 0)
+        its.it_value.tv_nsec = 1;
+
+    if (periodic)
+        its.it_interval = its.it_value;
+
+    return timerfd_settime(timer_fd, 0, &its, NULL);
+}
+
+int Timer::stop() {
+    if (timer_fd < 0)
+        return -1;
+
+    struct itimerspec its;
+    memset(&its, 0, sizeof(struct itimerspec));
+
+    return timerfd_settime(timer_fd, 0, &its, NULL);
+}
+
+/* EventHandler overrides */
+
+int Timer::handle_event(int fd, uint32_t, bool &) {
+    uint64_t expirations;
+    if (read(fd, &expirations, sizeof(expirations)) != sizeof(expirations))
+        return -1;
+
+    if (on_timer)
+        on_timer();
+
+    return 0;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "dispatcher/EventHandler.h"
+
+#include <functional>
+
+class Timer: public EventHandler
+{
+    public:
+        Timer(std::function<void ()> callback);
+        virtual ~Timer();
+        int start(long timeout_ms, bool periodic = true);
+        int stop();
+        /* EventHandler overrides */
+        int handle_event(int fd, uint32_t events, bool &stop) override;
+
+    private:
+        int init_timer();
+        int timer_fd = -1;
+        std::function<void ()> on_timer;
+};
@@ -5,6 +5,7 @@
 #include "resolver/Resolver.h"
 #include "CnamHttpDriver.h"
 #include "JsonHelpers.h"
+#include "JsonView.h"
 
 #include <type_traits>
 
@@ -12,115 +13,6 @@
  * Configuration implementation
 ***************************************************************/
 
-void CCnamHttpDriverCfg::TemplateProcessor::parse_url_template(string &url)
-{
-    //split url to the parts
-    auto s = url.data();
-    enum {
-        ST_NORMAL = 0,
-        ST_PLACEHOLDER
-    } state = ST_NORMAL;
-
-    size_t i, pos = 0;
-
-    for(i = 0; i < url.size(); i++)
-    {
-        char c = s[i];
-        switch(state) {
-        case ST_NORMAL:
-            switch(c) {
-            case '{':
-                //new placeholder
-                if(i > pos) {
-                    //save previous static part
-                    uri_parts.emplace_back(
-                        UriPart::URI_PART_STRING,
-                        url.substr(pos, i - pos));
-                }
-                pos = i+1;
-                state = ST_PLACEHOLDER;
-                break;
-            case '}':
-                throw std::runtime_error("unexpected '}' in the url template");
-            default:
-                break;
-            } //switch(c)
-            break;
-        case ST_PLACEHOLDER:
-            switch(c) {
-            case '}':
-                //placeholder closed
-                if(1 > (i - pos)) {
-                    throw std::runtime_error("empty placeholder in the url template");
-                }
-                uri_parts.emplace_back(
-                    UriPart::URI_PART_PLACEHOLDER,
-                    url.substr(pos, i - pos));
-                pos = i+1;
-                state = ST_NORMAL;
-                break;
-            case '{':
-                throw std::runtime_error("unexpected '{' in the url template");
-            default:
-                break;
-            } //switch(c)
-            break;
-        }
-    }
-
-    if(ST_PLACEHOLDER == state) {
-        throw std::runtime_error("unclosed placeholder in the url template");
-    }
-
-    if(i > pos) {
-        //save tail static part
-        uri_parts.emplace_back(
-            UriPart::URI_PART_STRING,
-            url.substr(pos, i - pos));
-    }
-
-    /*for(auto &p: uri_parts) {
-        dbg("uri_part %d %s", p.type, p.data.data());
-    }*/
-}
-
-string CCnamHttpDriverCfg::TemplateProcessor::get_url(cJSON *j) const
-{
-    string ret;
-    for(const auto &p: uri_parts) {
-        switch(p.type) {
-        case UriPart::URI_PART_STRING:
-            ret += p.data;
-            break;
-        case UriPart::URI_PART_PLACEHOLDER:
-            auto item = cJSON_GetObjectItem(j, p.data.data());
-            if(!item)
-                throw CDriver::error(
-                    "missed required key '%s' in request",
-                    p.data.data());
-            switch(item->type) {
-            case cJSON_String:
-                ret += item->valuestring;
-                break;
-            case cJSON_Number:
-                ret += std::to_string(item->valueint);
-                break;
-            case cJSON_True:
-                ret += '1';
-                break;
-            case cJSON_False:
-                ret += '0';
-                break;
-            default:
-                throw CDriver::error(
-                    "unsupported hash item type %d by key '%s'",
-                    item->type, p.data.data());
-            }
-            break;
-        }
-    }
-    return ret;
-}
 /**
  * @brief Driver configuration constructor
  *
@@ -142,9 +34,10 @@ CCnamHttpDriverCfg::CCnamHttpDriverCfg(const CDriverCfg::RawConfig_t & data)
         auto &j = *jptr;
 
         timeout = getJsonValueByKey<CfgTimeout_t>(j, "timeout");
+        http_opts.parse(j);
 
         set_str_var(url);
-        template_processor.parse_url_template(url);
+        url_template.parse(url);
 
     } catch (std::exception & e) {
         throw error(getLabel(), e.what());
@@ -162,7 +55,8 @@ CCnamHttpDriverCfg::CCnamHttpDriverCfg(const CDriverCfg::RawConfig_t & data)
  */
 CCnamHttpDriver::CCnamHttpDriver(const CDriverCfg::RawConfig_t & data)
   : CDriver(ECDriverId::ERESOLVER_DIRVER_CNAM_HTTP, "CNAM HTTP"),
-    cfg(data)
+    cfg(data),
+    probe_url(AsyncHttpClient::get_origin_url(cfg.url))
 {}
 
 /**
@@ -187,15 +81,49 @@ void CCnamHttpDriver::resolve(
 {
 
     //parse inData as json
-    std::unique_ptr<cJSON, void(*)(cJSON*)> request_json(
-        cJSON_Parse(request.data.data()), cJSON_Delete);
-    if(!request_json)
+    JsonView request_json(request.data);
+    if(!request_json.isValid())
         throw CDriver::error("failed to parse request json");
-    if(request_json->type != cJSON_Object)
+    if(!request_json.isObject())
         throw CDriver::error("expected JSON object in request");
 
     //replace placeholders in dstURL using data from json
-    string dstURL = cfg.template_processor.get_url(request_json.get());
+    const string &dstURL = cfg.url_template.render_with(
+        [&request_json](const string &key, string &out)
+    {
+        auto item = request_json.get(key);
+        long number;
+        string value;
+
+        switch(item.type()) {
+        case JsonView::JSON_INVALID:
+            throw CDriver::error(
+                "missed required key '%s' in request",
+                key.data());
+        case JsonView::JSON_STRING:
+            if(string_view::npos == item.raw().find('\\')) {
+                UrlTemplate::append_encoded(out, item.raw());
+            } else {
+                item.getString(value);
+                UrlTemplate::append_encoded(out, value);
+            }
+            break;
+        case JsonView::JSON_NUMBER:
+            item.getInt(number);
+            out += std::to_string(number);
+            break;
+        case JsonView::JSON_TRUE:
+            out += '1';
+            break;
+        case JsonView::JSON_FALSE:
+            out += '0';
+            break;
+        default:
+            throw CDriver::error(
+                "unsupported hash item type %d by key '%s'",
+                item.type(), key.data());
+        }
+    });
 
     HttpRequest http_request;
     http_request.id = request.id;
@@ -206,26 +134,27 @@ void CCnamHttpDriver::resolve(
     http_request.auth_type = ECAuth::NONE;
     http_request.timeout_ms = cfg.timeout;
     http_request.headers = { "Content-Type: application/json" };
+    http_request.conn_opts = &cfg.http_opts;
 
     if (handler != nullptr)
         handler->make_http_request(resolver, request, http_request);
 }
 
 void CCnamHttpDriver::parse(const string &data, ResolverRequest &request) const {
-    request.result.rawData = data;
+    static const string_view prefix("{\"response\":");
 
-    std::unique_ptr<cJSON, void(*)(cJSON*)> j(
-        cJSON_Parse(data.data()),cJSON_Delete);
-    if(!j)
+    //validate reply without building the tree
+    JsonView j(data);
+    if(!j.isValid())
         throw CDriver::error("failed to parse reply JSON");
-    if(j->type != cJSON_Object)
+    if(!j.isObject())
         throw CDriver::error("expected JSON object in reply");
 
-    auto response_json = cJSON_CreateObject();
-    cJSON_AddItemReferenceToObject(response_json, "response", j.get());
-    char *s = cJSON_PrintUnformatted(response_json);
-    cJSON_Delete(response_json);
-
-    request.result.rawData = s;
-    free(s);
+    //wrap reply object as is
+    auto &raw = request.result.rawData;
+    raw.clear();
+    raw.reserve(prefix.size() + j.raw().size() + 1);
+    raw.append(prefix.data(), prefix.size())
+       .append(j.raw().data(), j.raw().size())
+       .push_back('}');
 }
@@ -2,6 +2,8 @@
 
 #include "Driver.h"
 #include "libs/cJSON.h"
+#include "drivers/modules/AsyncHttpClient.h"
+#include "drivers/modules/UrlTemplate.h"
 
 #include <map>
 using std::map;
@@ -16,26 +18,9 @@ struct CCnamHttpDriverCfg: public CDriverCfg
 {
     string url;
     CfgTimeout_t timeout;
+    HttpConnOptions http_opts;
 
-    class TemplateProcessor {
-      private:
-        struct UriPart {
-            enum uri_part_type {
-                URI_PART_STRING = 0,
-                URI_PART_PLACEHOLDER
-            } type;
-            //string or placeholder key
-            string data;
-            UriPart(uri_part_type type, const string &data)
-              : type(type),
-                data(data)
-            {}
-        };
-        vector<UriPart> uri_parts;
-      public:
-        void parse_url_template(string &uri);
-        string get_url(cJSON *j) const;
-    } template_processor;
+    UrlTemplate url_template;
 
     explicit CCnamHttpDriverCfg(const CDriverCfg::RawConfig_t & data);
 };
@@ -47,7 +32,7 @@ class CCnamHttpDriver: public CDriver
 {
   private:
     CCnamHttpDriverCfg cfg;
-    //
+    string probe_url;
   public:
     explicit CCnamHttpDriver(const CDriverCfg::RawConfig_t & data);
     ~CCnamHttpDriver() override = default;
@@ -62,6 +47,15 @@ class CCnamHttpDriver: public CDriver
                  ResolverHandler *handler) const override;
     void parse(const string &data, ResolverRequest &request) const override;
 
+    const HttpConnOptions * getHttpConnOptions() const override
+    {
+        return &cfg.http_opts;
+    }
+    const char * getHttpProbeUrl() const override
+    {
+        return probe_url.c_str();
+    }
+
     const CDriverCfg::CfgUniqId_t getUniqueId() const override
     {
         return cfg.getUniqId();
@@ -73,6 +73,25 @@ unique_ptr<CDriver> CDriver::instantiate(const CDriverCfg::RawConfig_t & data)
   return rv;
 };
 
+/**
+ * @brief Default batch resolving handler for drivers without bulk API
+ */
+void CDriver::resolve_batch(vector<ResolverRequest> &,
+                            Resolver *,
+                            ResolverHandler *) const
+{
+  throw error("batch resolving is not supported by '%s' driver", getName());
+}
+
+/**
+ * @brief Default batch reply parser for drivers without bulk API
+ */
+void CDriver::parse_batch(const string &,
+                          vector<ResolverRequest> &) const
+{
+  throw error("batch resolving is not supported by '%s' driver", getName());
+}
+
 void CDriver::init_metrics()
 {
     prometheus_exporter::instance()->
@@ -96,3 +115,22 @@ void CDriver::requests_finished_increment(const double time_consumed)
     prometheus_exporter::instance()->
         driver_requests_finished_increment(getName(), getUniqueId(), time_consumed);
 }
+
+void CDriver::http_probe_finished(const bool is_success, const double time_consumed)
+{
+    prometheus_exporter::instance()->
+        driver_http_probe_finished(getName(), getUniqueId(), is_success, time_consumed);
+}
+
+void CDriver::index_loaded(const unsigned long generation, const size_t rows,
+                           const size_t bytes, const double build_time)
+{
+    prometheus_exporter::instance()->
+        driver_index_loaded(getName(), getUniqueId(), generation, rows, bytes, build_time);
+}
+
+void CDriver::http_connection_increment(const bool is_reused)
+{
+    prometheus_exporter::instance()->
+        driver_http_connection_increment(getName(), getUniqueId(), is_reused);
+}
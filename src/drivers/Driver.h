@@ -6,6 +6,9 @@ using std::string;
 #include <memory>
 using std::unique_ptr;
 
+#include <vector>
+using std::vector;
+
 #include "libs/fmterror.h"
 #include "DriverDefines.h"
 #include "DriverConfig.h"
@@ -13,6 +16,7 @@ using std::unique_ptr;
 class Resolver;
 struct ResolverRequest;
 class ResolverHandler;
+struct HttpConnOptions;
 
 /**
  * @brief Resolver driver class
@@ -57,6 +61,10 @@ class CDriver
     virtual const CDriverCfg::CfgUniqId_t getUniqueId() const = 0;
     virtual void showInfo() const = 0;
 
+    // Called on the dispatcher thread when the created driver is put
+    // in service, dispatcher event handlers must be created here
+    virtual void activate() {}
+
     virtual int getDriverType() const { return DriverTypeTagged; };
     virtual void resolve(ResolverRequest &request,
                          Resolver *resolver,
@@ -64,6 +72,20 @@ class CDriver
 
     virtual void parse(const string &data, ResolverRequest &request) const = 0;
 
+    // Optional micro-batching: requests collected for up to getBatchDelay()
+    // milliseconds or getBatchSize() numbers are resolved by one provider call
+    virtual unsigned int getBatchSize() const  { return 0; }
+    virtual unsigned int getBatchDelay() const { return 0; }
+    virtual void resolve_batch(vector<ResolverRequest> &requests,
+                               Resolver *resolver,
+                               ResolverHandler *handler) const;
+    virtual void parse_batch(const string &data,
+                             vector<ResolverRequest> &requests) const;
+
+    // HTTP based drivers connection settings and keep-warm probe target
+    virtual const HttpConnOptions * getHttpConnOptions() const { return nullptr; }
+    virtual const char * getHttpProbeUrl() const { return nullptr; }
+
     const char * getName() const  { return mName; }
 
     static unique_ptr<CDriver> instantiate(const CDriverCfg::RawConfig_t & data);
@@ -72,4 +94,8 @@ class CDriver
     void requests_count_increment();
     void requests_failed_increment();
     void requests_finished_increment(const double time_consumed);
+    void http_connection_increment(const bool is_reused);
+    void http_probe_finished(const bool is_success, const double time_consumed);
+    void index_loaded(const unsigned long generation, const size_t rows,
+                      const size_t bytes, const double build_time);
 };
@@ -7,6 +7,7 @@ using std::uint8_t;
 
 #include "Driver.h"
 #include "DriverConfig.h"
+#include "drivers/modules/AsyncHttpClient.h"
 
 // Initialize static member and predefined variables
 CDriverCfg::ECfgFormat_t CDriverCfg::sConfigType   = CDriverCfg::ECONFIG_DATA_INVALID;
@@ -38,7 +39,7 @@ const ECDriverId CDriverCfg::getID(const RawConfig_t & data)
           sConfigType = ECONFIG_DATA_AS_JSON_STRING;
           break;
         }
-      } catch (const pqxx::pqxx_exception & e) { }
+      } catch (const CRawConfig::error & e) { }
 
       try
       {
@@ -47,7 +48,7 @@ const ECDriverId CDriverCfg::getID(const RawConfig_t & data)
           sConfigType = ECONFIG_DATA_AS_SEPARATE_COLUMN_V2;
           break;
         }
-      } catch (const pqxx::pqxx_exception & e) { }
+      } catch (const CRawConfig::error & e) { }
 
       try
       {
@@ -56,7 +57,7 @@ const ECDriverId CDriverCfg::getID(const RawConfig_t & data)
           sConfigType = ECONFIG_DATA_AS_SEPARATE_COLUMN_V1;
           break;
         }
-      } catch (const pqxx::pqxx_exception & e) { }
+      } catch (const CRawConfig::error & e) { }
 
     } while(0);
   }
@@ -77,7 +78,7 @@ const ECDriverId CDriverCfg::getID(const RawConfig_t & data)
       driverId = drv->privateId;
     }
   }
-  catch (const pqxx::pqxx_exception &e)
+  catch (const CRawConfig::error & e)
   {
     // Database format for yeti-web v1.7
     uint16_t numId = data["o_driver_id"].as<uint16_t>(0);
@@ -172,6 +173,20 @@ const CDriverCfg::CfgUniqId_t CDriverCfg::getRawUniqId(const RawConfig_t & data)
   return uniqID;
 }
 
+/**
+ * @brief Method to retrieve driver unique identifier before
+ *        the driver creation with detection configuration format type
+ *
+ * @param[in] data  The database output with driver configuration
+ *
+ * @return driver unique identifier or -1 if it is not found
+ */
+const CDriverCfg::CfgUniqId_t CDriverCfg::getConfigUniqId(const RawConfig_t & data)
+{
+  getID(data);
+  return getRawUniqId(data);
+}
+
 /**
  * @brief Method to retrieve driver user defined label
  *
@@ -352,6 +367,33 @@ const CDriverCfg::CfgUserName_t CDriverCfg::getRawUserName(JSONConfig_t & data)
   return userName;
 }
 
+/**
+ * @brief Method for retrieving optional HTTP connection reuse settings
+ *        (http2, keepalive_idle, keepalive_interval, max_idle_time)
+ *
+ * @note Available for JSON format only. Missed keys keep default values
+ *
+ * @param[in]     data  The database output with driver configuration
+ * @param[in,out] opts  The connection options to fill
+ */
+void CDriverCfg::getRawHttpConnOptions(const RawConfig_t & data,
+                                       HttpConnOptions & opts)
+{
+  if (ECONFIG_DATA_AS_JSON_STRING != sConfigType)
+  {
+    return;
+  }
+
+  std::unique_ptr<cJSON, void(*)(cJSON*)> j(
+    cJSON_Parse(data["parameters"].c_str()), cJSON_Delete);
+  if (!j)
+  {
+    throw error("failed to parse json");
+  }
+
+  opts.parse(*j);
+}
+
 /**
  * @brief Constructor method for basic class
  */
@@ -10,8 +10,7 @@ using std::runtime_error;
 #include <string>
 using std::string;
 
-#include <pqxx/pqxx>
-
+#include "RawConfig.h"
 #include "libs/jsonxx.h"
 #include "libs/fmterror.h"
 
@@ -19,6 +18,7 @@ using std::string;
  * @brief Enum typedef forward declaration
  */
 enum class ECDriverId : uint8_t;
+struct HttpConnOptions;
 
 /**
  * @brief Driver configuration interface
@@ -59,7 +59,7 @@ class CDriverCfg
     using CfgFlag_t     = bool;
 
     // Raw driver configuration
-    using RawConfig_t = pqxx::row;
+    using RawConfig_t = CRawConfig;
     // JSON driver configuration
     using JSONConfig_t = jsonxx;
 
@@ -100,11 +100,15 @@ class CDriverCfg
     static const CfgUserName_t getRawUserName(const RawConfig_t & data);
     static const CfgUserName_t getRawUserName(JSONConfig_t & data);
 
+    static void getRawHttpConnOptions(const RawConfig_t & data,
+                                      HttpConnOptions & opts);
+
   public:
     explicit CDriverCfg(const RawConfig_t & data);
     virtual ~CDriverCfg() = default;
 
     static const ECDriverId   getID(const RawConfig_t & data);
+    static const CfgUniqId_t  getConfigUniqId(const RawConfig_t & data);
     static const ECfgFormat_t getFormatType();
     static const char *       getFormatStrType();
 
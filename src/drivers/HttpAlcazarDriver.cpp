@@ -4,6 +4,7 @@
 #include "log.h"
 #include "resolver/Resolver.h"
 #include "HttpAlcazarDriver.h"
+#include "JsonView.h"
 
 /**************************************************************
  * Configuration implementation
@@ -74,6 +75,8 @@ CHttpAlcazarDriverCfg::CHttpAlcazarDriverCfg(const CDriverCfg::RawConfig_t & dat
 
       mPort    = getRawPort(jData);
       mTimeout = getRawTimeout(jData);
+
+      getRawHttpConnOptions(data, mHttpOpts);
     }
     catch (std::exception & e)
     {
@@ -122,11 +125,15 @@ CHttpAlcazarDriver::CHttpAlcazarDriver(const CDriverCfg::RawConfig_t & data)
     url << ":" << std::dec << port;
   }
 
-  url << "/api/2.2/lrn?extended=true&output=json";
+  url << "/";
+  mProbeURL = url.str();
+
+  url << "api/2.2/lrn?extended=true&output=json";
   url << "&key=" << mCfg->geKey();
   url << "&tn=";
 
-  mURLPrefix = url.str();
+  mURL.append_string(url.str());
+  mURL.append_placeholder("number");
 }
 
 /**
@@ -155,7 +162,7 @@ void CHttpAlcazarDriver::resolve(ResolverRequest &request,
    *      key=5ddc2fba-0cc4-4c93-9a28-bd28ddf5e6d4&tn=14846642959
    */
 
-    string dstURL = mURLPrefix + request.data;
+    const string &dstURL = mURL.render(request.data);
     dbg("resolving by URL: '%s'", dstURL.c_str());
 
     HttpRequest http_request;
@@ -167,6 +174,7 @@ void CHttpAlcazarDriver::resolve(ResolverRequest &request,
     http_request.auth_type = ECAuth::NONE;
     http_request.timeout_ms = mCfg->getTimeout();
     http_request.headers = { "Content-Type: application/json" };
+    http_request.conn_opts = &mCfg->getHttpConnOptions();
 
     if (handler != nullptr)
         handler->make_http_request(resolver, request, http_request);
@@ -188,20 +196,16 @@ void CHttpAlcazarDriver::parse(const string &data, ResolverRequest &request) con
      * }
      */
 
-  try {
-    jsonxx jdata{data};
-    request.result.localRoutingNumber =
-      static_cast<decltype(request.result.localRoutingNumber)> (
-        jdata["LRN"]);
-    request.result.localRoutingTag =
-      static_cast<decltype(request.result.localRoutingTag)> (
-        jdata["JURISDICTION"]);
-  }
-  catch (std::exception & e)
+  // both values are picked up in a single pass over the reply
+  JsonView lrn, jurisdiction;
+  if (2 != JsonView(data).extract({ { "LRN", &lrn }, { "JURISDICTION", &jurisdiction } }))
   {
     warn("couldn't parse reply as JSON format: '%s'", data.c_str());
-    throw error(e.what());
+    throw error("no 'LRN' or 'JURISDICTION' value in reply");
   }
 
+  lrn.getString(request.result.localRoutingNumber, true);
+  jurisdiction.getString(request.result.localRoutingTag, true);
+
   request.result.rawData = data;
 }
@@ -2,6 +2,8 @@
 #define SERVER_SRC_DRIVERS_HTTPALCAZARDRIVER_H_
 
 #include "Driver.h"
+#include "drivers/modules/AsyncHttpClient.h"
+#include "drivers/modules/UrlTemplate.h"
 
 /**
  * @brief Driver configuration class
@@ -14,6 +16,7 @@ class CHttpAlcazarDriverCfg: public CDriverCfg
     CfgPort_t             mPort;
     CfgKey_t              mKey;
     CfgTimeout_t          mTimeout;
+    HttpConnOptions       mHttpOpts;
 
     // Driver specific getters for raw configuration processing
     static const CfgKey_t getRawKey(const RawConfig_t & data);
@@ -27,6 +30,7 @@ class CHttpAlcazarDriverCfg: public CDriverCfg
     const CfgPort_t    getPort() const     { return mPort; }
     const char *       geKey() const       { return mKey.c_str(); }
     const CfgTimeout_t getTimeout() const  { return mTimeout; }
+    const HttpConnOptions & getHttpConnOptions() const { return mHttpOpts; }
 };
 
 /**
@@ -36,7 +40,8 @@ class CHttpAlcazarDriver: public CDriver
 {
   private:
     unique_ptr<CHttpAlcazarDriverCfg> mCfg;
-    string mURLPrefix;
+    UrlTemplate mURL;
+    string mProbeURL;
 
   public:
     explicit CHttpAlcazarDriver(const CDriverCfg::RawConfig_t & data);
@@ -48,6 +53,10 @@ class CHttpAlcazarDriver: public CDriver
                  ResolverHandler *handler) const override;
     void parse(const string &data, ResolverRequest &request) const override;
 
+    const HttpConnOptions * getHttpConnOptions() const override
+                                                { return &mCfg->getHttpConnOptions(); }
+    const char * getHttpProbeUrl() const override { return mProbeURL.c_str(); }
+
     const CDriverCfg::CfgUniqId_t getUniqueId() const override
                                                 { return mCfg->getUniqId(); }
 };
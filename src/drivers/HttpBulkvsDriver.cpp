@@ -5,6 +5,7 @@
 #include "log.h"
 #include "resolver/Resolver.h"
 #include "HttpBulkvsDriver.h"
+#include "JsonView.h"
 
 using namespace std;
 
@@ -97,6 +98,9 @@ CHttpBulkvsDriverCfg::CHttpBulkvsDriverCfg(const CDriverCfg::RawConfig_t & data)
 
       mTimeout = getRawTimeout(jData);
       mValidateHttpsCer = getRawValidateHttpsCer(jData);
+
+      getRawHttpConnOptions(data, mHttpOpts);
+      mHttpOpts.verify_ssl = mValidateHttpsCer;
     }
     catch (std::exception & e)
     {
@@ -116,6 +120,16 @@ CHttpBulkvsDriverCfg::CHttpBulkvsDriverCfg(const CDriverCfg::RawConfig_t & data)
 CHttpBulkvsDriver::CHttpBulkvsDriver(const CDriverCfg::RawConfig_t & data)
     :CDriver(ECDriverId::ERESOLVER_DIRVER_HTTP_BULKVS, "Buklvs API") {
     mCfg.reset(new CHttpBulkvsDriverCfg(data));
+    mProbeURL = AsyncHttpClient::get_origin_url(mCfg->getUrl());
+
+    std::ostringstream url;
+    url << mCfg->getUrl();
+    url << "/?id=" << mCfg->getToken();
+    url << "&did=";
+
+    mURL.append_string(url.str());
+    mURL.append_placeholder("number");
+    mURL.append_string("&format=json");
 }
 
 /**
@@ -141,13 +155,7 @@ void CHttpBulkvsDriver::resolve(ResolverRequest &request,
    * {url}/?id={token}&did={inData}&format=json
    */
 
-    std::ostringstream url;
-    url << mCfg->getUrl();
-    url << "/?id=" << mCfg->getToken();
-    url << "&did=" << request.data;
-    url << "&format=json";
-
-    string dstURL = url.str();
+    const string &dstURL = mURL.render(request.data);
     dbg("resolving by URL: '%s'", dstURL.c_str());
 
     HttpRequest http_request;
@@ -157,6 +165,7 @@ void CHttpBulkvsDriver::resolve(ResolverRequest &request,
     http_request.verify_ssl = mCfg->getValidateHttpsCer();
     http_request.auth_type = ECAuth::BASIC;
     http_request.timeout_ms = mCfg->getTimeout();
+    http_request.conn_opts = &mCfg->getHttpConnOptions();
 
     if (handler != nullptr)
         handler->make_http_request(resolver, request, http_request);
@@ -173,14 +182,13 @@ void CHttpBulkvsDriver::resolve(ResolverRequest &request,
     * }
     */
 
-    try {
-        request.result.localRoutingNumber =
-            static_cast<decltype(request.result.localRoutingNumber)>(jsonxx(data)["name"]);
-    }
-    catch (std::exception & e) {
+    JsonView name;
+    if (!JsonView(data).extract({ { "name", &name } })) {
         warn("couldn't parse reply as JSON format: '%s'", data.c_str());
-        throw error(e.what());
+        throw error("no 'name' value in reply");
     }
 
+    name.getString(request.result.localRoutingNumber, true);
+
     request.result.rawData = data;
 }
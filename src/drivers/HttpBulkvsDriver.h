@@ -3,6 +3,7 @@
 
 #include "Driver.h"
 #include "resolver/Resolver.h"
+#include "drivers/modules/UrlTemplate.h"
 
 /**
  * @brief Driver configuration class
@@ -14,6 +15,7 @@ class CHttpBulkvsDriverCfg: public CDriverCfg
     CfgKey_t              mToken;
     CfgTimeout_t          mTimeout;
     CfgFlag_t             mValidateHttpsCer;
+    HttpConnOptions       mHttpOpts;
 
     static const CfgUrl_t getRawUrl(JSONConfig_t & data);
     static const CfgKey_t getRawToken(JSONConfig_t & data);
@@ -26,6 +28,7 @@ class CHttpBulkvsDriverCfg: public CDriverCfg
     const CfgUrl_t       getUrl() const                 { return mUrl; }
     const CfgTimeout_t   getTimeout() const             { return mTimeout; }
     const CfgFlag_t      getValidateHttpsCer() const    { return mValidateHttpsCer; }
+    const HttpConnOptions & getHttpConnOptions() const  { return mHttpOpts; }
 };
 
 /**
@@ -35,6 +38,8 @@ class CHttpBulkvsDriver: public CDriver
 {
   private:
     unique_ptr<CHttpBulkvsDriverCfg> mCfg;
+    UrlTemplate mURL;
+    string mProbeURL;
 
   public:
     explicit CHttpBulkvsDriver(const CDriverCfg::RawConfig_t & data);
@@ -47,6 +52,10 @@ class CHttpBulkvsDriver: public CDriver
 
     void parse(const string &data, ResolverRequest &request) const override;
 
+    const HttpConnOptions * getHttpConnOptions() const override
+                                                { return &mCfg->getHttpConnOptions(); }
+    const char * getHttpProbeUrl() const override { return mProbeURL.c_str(); }
+
     const CDriverCfg::CfgUniqId_t getUniqueId() const override
                                                 { return mCfg->getUniqId(); }
 };
@@ -1,10 +1,13 @@
 #include <sstream>
 #include <cstring>
+#include <algorithm>
 
 #include "log.h"
 #include "resolver/Resolver.h"
 #include "HttpCoureAnqDriver.h"
 #include "JsonHelpers.h"
+#include "JsonView.h"
+#include "drivers/modules/NumberFormat.h"
 
 #include <type_traits>
 
@@ -75,6 +78,13 @@ CHttpCoureAnqDriverCfg::CHttpCoureAnqDriverCfg(const CDriverCfg::RawConfig_t & d
         set_str_var(password);
         set_str_var(country_code);
         timeout = getJsonValueByKey<CfgTimeout_t>(j, "timeout");
+        http_opts.parse(j);
+
+        //optional bulk lookup settings
+        if(cJSON_GetObjectItem(&j, "batch_size"))
+            batch_size = getJsonValueByKey<unsigned int>(j, "batch_size");
+        if(cJSON_GetObjectItem(&j, "batch_delay"))
+            batch_delay = getJsonValueByKey<unsigned int>(j, "batch_delay");
 
         //read operators map
         auto m = cJSON_GetObjectItem(&j, "operators_map");
@@ -115,8 +125,8 @@ CHttpCoureAnqDriver::CHttpCoureAnqDriver(const CDriverCfg::RawConfig_t & data)
   : CDriver(ECDriverId::ERESOLVER_DIRVER_HTTP_COUREANQ, "Coure ANQ"),
     cfg(data)
 {
-    std::ostringstream url;
-    url << cfg.base_url <<
+    std::ostringstream url_prefix;
+    url_prefix << cfg.base_url <<
         "/api/json/LookUpNumber/GsmPortStatus?" <<
         "username=" << cfg.username <<
         "&password=" << cfg.password <<
@@ -124,8 +134,13 @@ CHttpCoureAnqDriver::CHttpCoureAnqDriver(const CDriverCfg::RawConfig_t & data)
         "&country=" << cfg.country_code <<
         "&numbersToLookUp=";
 
-    url_prefix = url.str();
-    //dbg("url_prefix: %s",url_prefix.data());
+    url.append_string(url_prefix.str());
+    url.append_placeholder("numbers");
+    //bulk lookup value is the comma separated list
+    if(cfg.batch_size > 1)
+        url.set_max_value_size(UrlTemplate::DEFAULT_MAX_VALUE_SIZE * cfg.batch_size);
+
+    probe_url = AsyncHttpClient::get_origin_url(cfg.base_url);
 }
 
 /**
@@ -133,12 +148,14 @@ CHttpCoureAnqDriver::CHttpCoureAnqDriver(const CDriverCfg::RawConfig_t & data)
  */
 void CHttpCoureAnqDriver::showInfo() const
 {
-    info("[%u/%s] '%s' driver => base_url:<%s>, timeout:%u milliseconds, country_code:%s",
+    info("[%u/%s] '%s' driver => base_url:<%s>, timeout:%u milliseconds, country_code:%s, "
+         "batch_size:%u, batch_delay:%u milliseconds",
         cfg.getUniqId(),
         cfg.getLabel(), getName(),\
         cfg.base_url.c_str(),
         cfg.timeout,
-        cfg.country_code.data());
+        cfg.country_code.data(),
+        cfg.batch_size, cfg.batch_delay);
 }
 
 /**
@@ -158,7 +175,7 @@ void CHttpCoureAnqDriver::resolve(ResolverRequest &request,
     * numbersToLookUp=08075597646
     */
 
-    string dstURL = url_prefix + request.data;
+    const string &dstURL = url.render(request.data);
 
     HttpRequest http_request;
     http_request.id = request.id;
@@ -168,51 +185,72 @@ void CHttpCoureAnqDriver::resolve(ResolverRequest &request,
     http_request.auth_type = ECAuth::NONE;
     http_request.timeout_ms = cfg.timeout;
     http_request.headers = { "Content-Type: application/json" };
+    http_request.conn_opts = &cfg.http_opts;
 
     if (handler != nullptr)
         handler->make_http_request(resolver, request, http_request);
 }
 
-void CHttpCoureAnqDriver::parse(const string &data, ResolverRequest &request) const {
+/**
+ * @brief Executing bulk resolving procedure
+ * @note numbers are passed as comma separated 'numbersToLookUp' list
+ */
+void CHttpCoureAnqDriver::resolve_batch(vector<ResolverRequest> &requests,
+                                        Resolver *resolver,
+                                        ResolverHandler *handler) const {
+    const string &dstURL = url.render_with([&requests](const string &, string &out) {
+        for(size_t i = 0; i < requests.size(); i++) {
+            if(i) out += ',';
+            UrlTemplate::append_encoded(out, requests[i].data);
+        }
+    });
 
-    /*
-    Processing reply. Example:
-     {
-            "Result": [
-             {
-                 "CountryCode": "235",
-                 "IsPorted": 1,
-                 "Number": "2347068970633",
-                 "OperatorMobileNumberCode": "49",
-                 "TheOperator": "ETS",
-                 "UniversalNumberFormat": "2347068970633"
-             }
-         ]
-      }
-    */
+    dbg("resolving %zu numbers by URL: '%s'", requests.size(), dstURL.c_str());
 
-    request.result.rawData = data;
+    HttpRequest http_request;
+    http_request.method = GET;
+    http_request.url = dstURL.c_str();
+    http_request.verify_ssl = false;
+    http_request.auth_type = ECAuth::NONE;
+    http_request.timeout_ms = cfg.timeout;
+    http_request.headers = { "Content-Type: application/json" };
+    http_request.conn_opts = &cfg.http_opts;
 
-    std::unique_ptr<cJSON, void(*)(cJSON*)> j(cJSON_Parse(data.data()),cJSON_Delete);
-    if(!j)
+    if (handler != nullptr)
+        handler->make_http_batch_request(resolver, requests, http_request);
+}
+
+JsonView CHttpCoureAnqDriver::parse_result_array(const string &data) const {
+    JsonView j(data);
+    if(!j.isValid())
         throw CDriver::error("failed to parse reply JSON");
-    if(j->type != cJSON_Object)
+    if(!j.isObject())
         throw CDriver::error("expected JSON object in reply");
 
-    auto result_j = cJSON_GetObjectItem(j.get(),"Result");
-    if(!result_j)
+    auto result_j = j.get("Result");
+    if(!result_j.isValid())
         throw CDriver::error("no \"Result\" key in reply");
-    if(result_j->type != cJSON_Array)
+    if(!result_j.isArray())
         throw CDriver::error("expected array in \"Result\" key in reply");
-    if(!result_j->child)
+    if(!result_j.front().isValid())
         throw CDriver::error("empty array in \"Result\" key in reply");
 
-    auto data_j = result_j->child;
-    if(data_j->type != cJSON_Object)
+    return result_j;
+}
+
+void CHttpCoureAnqDriver::parse_result(const JsonView &data_j, ResolverRequest &request) const {
+    if(!data_j.isObject())
         throw CDriver::error("expected object array in \"Result\" key in reply");
 
+    JsonView ported_j, number_j, operator_j;
+    data_j.extract({ { "IsPorted", &ported_j },
+                     { "Number", &number_j },
+                     { "TheOperator", &operator_j } });
+
     //check if ported
-    auto ported = getJsonValueByKey<int>(*data_j, "IsPorted");
+    long ported;
+    if(!ported_j.getInt(ported))
+        throw CDriver::error("no numeric \"IsPorted\" value in reply");
     switch(ported) {
     case 1: //ported
         break;
@@ -223,15 +261,105 @@ void CHttpCoureAnqDriver::parse(const string &data, ResolverRequest &request) co
         request.result.localRoutingTag.clear();
         return;
     default:
-        warn("unexpected ported value %d in reply",ported);
+        warn("unexpected ported value %ld in reply",ported);
         throw CDriver::error("unexpected ported \"IsPorted\" value in reply");
     }
 
     //!FIXME: should we use UniversalNumberFormat here ?
-    request.result.localRoutingNumber = getJsonValueByKey<string>(*data_j, "Number");
+    if(!number_j.getString(request.result.localRoutingNumber, true))
+        throw CDriver::error("no string \"Number\" value in reply");
 
     //get and resolve tag
+    string operator_name;
+    if(!operator_j.getString(operator_name, true))
+        throw CDriver::error("no string \"TheOperator\" value in reply");
     request.result.localRoutingTag = std::to_string(
-        cfg.operators_map.resolve(
-            getJsonValueByKey<string>(*data_j, "TheOperator")));
+        cfg.operators_map.resolve(operator_name));
+}
+
+void CHttpCoureAnqDriver::parse(const string &data, ResolverRequest &request) const {
+
+    /*
+    Processing reply. Example:
+     {
+            "Result": [
+             {
+                 "CountryCode": "235",
+                 "IsPorted": 1,
+                 "Number": "2347068970633",
+                 "OperatorMobileNumberCode": "49",
+                 "TheOperator": "ETS",
+                 "UniversalNumberFormat": "2347068970633"
+             }
+         ]
+      }
+    */
+
+    request.result.rawData = data;
+
+    parse_result(parse_result_array(data).front(), request);
+}
+
+/**
+ * @brief Parse bulk lookup reply
+ * @note "Result" array items are matched with the requests by their
+ *       "Number" (or "UniversalNumberFormat") national significant
+ *       number, so national format requests match international reply
+ *       numbers, and dropped or reordered items never give another
+ *       number's result.
+ *       Requests without reply item are left not done
+ */
+void CHttpCoureAnqDriver::parse_batch(const string &data,
+                                      vector<ResolverRequest> &requests) const {
+    auto result_j = parse_result_array(data);
+
+    struct Item {
+        JsonView j;
+        string number, universal;
+        bool used;
+    };
+    vector<Item> items;
+    for(auto data_j = result_j.front(); data_j.isValid(); data_j = result_j.next(data_j)) {
+        JsonView number_j, universal_j;
+        if(data_j.isObject())
+            data_j.extract({ { "Number", &number_j },
+                             { "UniversalNumberFormat", &universal_j } });
+        items.push_back({ data_j,
+                          national_number(number_j.isString() ? number_j.raw() : string_view(),
+                                          cfg.country_code),
+                          national_number(universal_j.isString() ? universal_j.raw() : string_view(),
+                                          cfg.country_code),
+                          false });
+    }
+
+    for(auto &request : requests) {
+        const string digits = national_number(request.data, cfg.country_code);
+        auto it = std::find_if(items.begin(), items.end(), [&digits](const Item &i) {
+            return !i.used && !digits.empty() &&
+                   (i.number == digits || i.universal == digits);
+        });
+        if(it == items.end()) {
+            warn("no reply item for number '%s' in bulk reply", request.data.c_str());
+            continue;
+        }
+        it->used = true;
+
+        try {
+            parse_result(it->j, request);
+
+            //keep only own reply item as raw data
+            request.result.rawData.assign(it->j.raw().data(), it->j.raw().size());
+
+            request.is_done = true;
+        } catch(const std::exception &e) {
+            warn("failed to parse bulk reply item for number '%s': %s",
+                 request.data.c_str(), e.what());
+        }
+    }
+
+    for(const auto &i : items) {
+        if(!i.used)
+            warn("unexpected bulk reply item: %.*s",
+                 static_cast<int>(i.j.raw().size()), i.j.raw().data());
+    }
 }
@@ -2,6 +2,9 @@
 
 #include "Driver.h"
 #include "libs/cJSON.h"
+#include "drivers/modules/AsyncHttpClient.h"
+#include "drivers/modules/UrlTemplate.h"
+#include "JsonView.h"
 
 #include <map>
 using std::map;
@@ -17,6 +20,9 @@ struct CHttpCoureAnqDriverCfg: public CDriverCfg
     string password;
     string country_code;
     CfgTimeout_t timeout;
+    HttpConnOptions http_opts;
+    unsigned int batch_size = 0;   // numbers per bulk lookup, 0/1 - disabled
+    unsigned int batch_delay = 0;  // max batch collecting time (milliseconds)
 
     struct OperatorsMap_t
       : public map<string, unsigned int>
@@ -36,7 +42,11 @@ class CHttpCoureAnqDriver: public CDriver
 {
   private:
     CHttpCoureAnqDriverCfg cfg;
-    string url_prefix;
+    UrlTemplate url;
+    string probe_url;
+
+    void parse_result(const JsonView &data_j, ResolverRequest &request) const;
+    JsonView parse_result_array(const string &data) const;
 
   public:
     explicit CHttpCoureAnqDriver(const CDriverCfg::RawConfig_t & data);
@@ -48,6 +58,18 @@ class CHttpCoureAnqDriver: public CDriver
                  ResolverHandler *handler) const override;
     void parse(const string &data, ResolverRequest &request) const override;
 
+    unsigned int getBatchSize() const override  { return cfg.batch_size; }
+    unsigned int getBatchDelay() const override { return cfg.batch_delay; }
+    void resolve_batch(vector<ResolverRequest> &requests,
+                       Resolver *resolver,
+                       ResolverHandler *handler) const override;
+    void parse_batch(const string &data,
+                     vector<ResolverRequest> &requests) const override;
+
+    const HttpConnOptions * getHttpConnOptions() const override
+                                                { return &cfg.http_opts; }
+    const char * getHttpProbeUrl() const override { return probe_url.c_str(); }
+
     const CDriverCfg::CfgUniqId_t getUniqueId() const override
                                                 { return cfg.getUniqId(); }
 };
@@ -4,6 +4,7 @@
 #include "log.h"
 #include "resolver/Resolver.h"
 #include "HttpThinqDriver.h"
+#include "JsonView.h"
 
 
 /**************************************************************
@@ -82,6 +83,8 @@ CHttpThinqDriverCfg::CHttpThinqDriverCfg(const CDriverCfg::RawConfig_t & data)
 
       mPort    = getRawPort(jData);
       mTimeout = getRawTimeout(jData);
+
+      getRawHttpConnOptions(data, mHttpOpts);
     }
     catch (std::exception & e)
     {
@@ -136,10 +139,14 @@ CHttpThinqDriver::CHttpThinqDriver(const CDriverCfg::RawConfig_t & data)
     url << ":" << std::dec << port;
   }
 
-  url << "/lrn/extended/";
-  mURLPrefix = url.str();
+  url << "/";
+  mProbeURL = url.str();
+
+  url << "lrn/extended/";
 
-  mURLSuffix = "?format=json";
+  mURL.append_string(url.str());
+  mURL.append_placeholder("number");
+  mURL.append_string("?format=json");
 }
 
 /**
@@ -169,7 +176,7 @@ void CHttpThinqDriver::resolve(ResolverRequest &request,
    * https://api.thinq.com/lrn/extended/9194841422?format=json
    */
 
-    string dstURL = mURLPrefix + request.data + mURLSuffix;
+    const string &dstURL = mURL.render(request.data);
     dbg("resolving by URL: '%s'", dstURL.c_str());
 
     HttpRequest http_request;
@@ -182,6 +189,7 @@ void CHttpThinqDriver::resolve(ResolverRequest &request,
     http_request.timeout_ms = mCfg->getTimeout();
     http_request.url = dstURL.c_str();
     http_request.headers = { "Content-Type: application/json" };
+    http_request.conn_opts = &mCfg->getHttpConnOptions();
 
     if (handler != nullptr)
         handler->make_http_request(resolver, request, http_request);
@@ -206,14 +214,13 @@ void CHttpThinqDriver::parse(const string &data, ResolverRequest &request) const
     * }
     */
 
-    try {
-        request.result.localRoutingNumber =
-            static_cast<decltype(request.result.localRoutingNumber)>(jsonxx(data)["lrn"]);
-    }
-    catch (std::exception & e) {
+    JsonView lrn;
+    if (!JsonView(data).extract({ { "lrn", &lrn } })) {
         warn("couldn't parse reply as JSON format: '%s'", data.c_str());
-        throw error(e.what());
+        throw error("no 'lrn' value in reply");
     }
 
+    lrn.getString(request.result.localRoutingNumber, true);
+
     request.result.rawData = data;
 }
@@ -2,6 +2,8 @@
 #define SERVER_SRC_DRIVERS_HTTPTHINQDRIVER_H_
 
 #include "Driver.h"
+#include "drivers/modules/AsyncHttpClient.h"
+#include "drivers/modules/UrlTemplate.h"
 
 /**
  * @brief Driver configuration class
@@ -15,6 +17,7 @@ class CHttpThinqDriverCfg: public CDriverCfg
     CfgUserName_t         mUserName;
     CfgToken_t            mToken;
     CfgTimeout_t          mTimeout;
+    HttpConnOptions       mHttpOpts;
 
     // Driver specific getters for raw configuration processing
     static const CfgToken_t getRawToken(const RawConfig_t & data);
@@ -29,6 +32,7 @@ class CHttpThinqDriverCfg: public CDriverCfg
     const char *        getUserName() const { return mUserName.c_str(); }
     const char *        geToken() const     { return mToken.c_str(); }
     const CfgTimeout_t  getTimeout() const  { return mTimeout; }
+    const HttpConnOptions & getHttpConnOptions() const { return mHttpOpts; }
 };
 
 /**
@@ -38,8 +42,8 @@ class CHttpThinqDriver: public CDriver
 {
   private:
     unique_ptr<CHttpThinqDriverCfg> mCfg;
-    string mURLPrefix;
-    string mURLSuffix;
+    UrlTemplate mURL;
+    string mProbeURL;
 
   public:
     explicit CHttpThinqDriver(const CDriverCfg::RawConfig_t & data);
@@ -51,6 +55,10 @@ class CHttpThinqDriver: public CDriver
                  ResolverHandler *handler) const override;
     void parse(const string &data, ResolverRequest &request) const override;
 
+    const HttpConnOptions * getHttpConnOptions() const override
+                                                { return &mCfg->getHttpConnOptions(); }
+    const char * getHttpProbeUrl() const override { return mProbeURL.c_str(); }
+
     const CDriverCfg::CfgUniqId_t getUniqueId() const override
                                                 { return mCfg->getUniqId(); }
 };
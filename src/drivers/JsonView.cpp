@@ -0,0 +1,534 @@
+#include "JsonView.h"
+
+#include <cstring>
+
+namespace
+{
+
+const int maxNestingDepth = 64;
+
+/**
+ * @brief Forward JSON scanner over the non-owning buffer
+ */
+struct SScanner_t
+{
+  const char * p;
+  const char * end;
+  int depth = 0;
+
+  SScanner_t(string_view data) : p(data.data()), end(data.data() + data.size()) { }
+
+  void skipWs()
+  {
+    while ((p < end) && ((' ' == *p) || ('\n' == *p) || ('\r' == *p) || ('\t' == *p)))
+    {
+      ++p;
+    }
+  }
+
+  bool consume(char c)
+  {
+    skipWs();
+    if ((p < end) && (c == *p))
+    {
+      ++p;
+      return true;
+    }
+    return false;
+  }
+
+  // p points to the opening quote. raw gets data between quotes
+  bool scanString(string_view & raw)
+  {
+    const char * start = ++p;
+    while (p < end)
+    {
+      char c = *p;
+      if ('"' == c)
+      {
+        raw = string_view(start, p - start);
+        ++p;
+        return true;
+      }
+      if ('\\' == c)
+      {
+        if (++p >= end)
+        {
+          return false;
+        }
+      }
+      else if (static_cast<unsigned char>(c) < 0x20)
+      {
+        return false;
+      }
+      ++p;
+    }
+    return false;
+  }
+
+  bool scanNumber()
+  {
+    const char * start = p;
+    if ((p < end) && ('-' == *p))
+    {
+      ++p;
+    }
+    const char * digits = p;
+    while ((p < end) && (((*p >= '0') && (*p <= '9')) || ('.' == *p) ||
+                         ('e' == *p) || ('E' == *p) || ('+' == *p) || ('-' == *p)))
+    {
+      ++p;
+    }
+    return (p > digits) && (p > start);
+  }
+
+  bool scanLiteral(const char * literal)
+  {
+    size_t len = std::strlen(literal);
+    if ((static_cast<size_t>(end - p) < len) || (0 != std::memcmp(p, literal, len)))
+    {
+      return false;
+    }
+    p += len;
+    return true;
+  }
+
+  bool scanContainer(char close)
+  {
+    if (++depth > maxNestingDepth)
+    {
+      return false;
+    }
+
+    ++p;
+    if (consume(close))
+    {
+      --depth;
+      return true;
+    }
+
+    do
+    {
+      JsonView::Type type;
+      string_view raw;
+
+      if ('}' == close)
+      {
+        skipWs();
+        if ((p >= end) || ('"' != *p) || !scanString(raw) || !consume(':'))
+        {
+          return false;
+        }
+      }
+
+      if (!scanValue(type, raw))
+      {
+        return false;
+      }
+    } while (consume(','));
+
+    if (!consume(close))
+    {
+      return false;
+    }
+
+    --depth;
+    return true;
+  }
+
+  bool scanValue(JsonView::Type & type, string_view & raw)
+  {
+    skipWs();
+    if (p >= end)
+    {
+      return false;
+    }
+
+    const char * start = p;
+    bool rv = false;
+
+    switch (*p)
+    {
+      case '"':
+        type = JsonView::JSON_STRING;
+        return scanString(raw);
+      case '{':
+        type = JsonView::JSON_OBJECT;
+        rv = scanContainer('}');
+        break;
+      case '[':
+        type = JsonView::JSON_ARRAY;
+        rv = scanContainer(']');
+        break;
+      case 't':
+        type = JsonView::JSON_TRUE;
+        rv = scanLiteral("true");
+        break;
+      case 'f':
+        type = JsonView::JSON_FALSE;
+        rv = scanLiteral("false");
+        break;
+      case 'n':
+        type = JsonView::JSON_NULL;
+        rv = scanLiteral("null");
+        break;
+      default:
+        type = JsonView::JSON_NUMBER;
+        rv = scanNumber();
+        break;
+    }
+
+    raw = string_view(start, p - start);
+    return rv;
+  }
+};
+
+/**
+ * @brief Iterate object members until callback returns false
+ *
+ * @return false on malformed object
+ */
+template <typename F>
+bool forEachMember(string_view object, F callback)
+{
+  SScanner_t s(object);
+
+  if (!s.consume('{'))
+  {
+    return false;
+  }
+  if (s.consume('}'))
+  {
+    return true;
+  }
+
+  do
+  {
+    string_view key, raw;
+    JsonView::Type type;
+
+    s.skipWs();
+    if ((s.p >= s.end) || ('"' != *s.p) || !s.scanString(key) || !s.consume(':'))
+    {
+      return false;
+    }
+    if (!s.scanValue(type, raw))
+    {
+      return false;
+    }
+    if (!callback(key, type, raw))
+    {
+      return true;
+    }
+  } while (s.consume(','));
+
+  return s.consume('}');
+}
+
+/**
+ * @brief Append UTF-8 representation of the code point
+ */
+void appendUtf8(string & out, unsigned long cp)
+{
+  if (cp < 0x80)
+  {
+    out += static_cast<char>(cp);
+  }
+  else if (cp < 0x800)
+  {
+    out += static_cast<char>(0xC0 | (cp >> 6));
+    out += static_cast<char>(0x80 | (cp & 0x3F));
+  }
+  else if (cp < 0x10000)
+  {
+    out += static_cast<char>(0xE0 | (cp >> 12));
+    out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (cp & 0x3F));
+  }
+  else
+  {
+    out += static_cast<char>(0xF0 | (cp >> 18));
+    out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+    out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (cp & 0x3F));
+  }
+}
+
+bool parseHex4(const char * p, const char * end, unsigned long & cp)
+{
+  if ((end - p) < 4)
+  {
+    return false;
+  }
+
+  cp = 0;
+  for (int i = 0; i < 4; ++i)
+  {
+    char c = p[i];
+    cp <<= 4;
+    if ((c >= '0') && (c <= '9'))      cp |= c - '0';
+    else if ((c >= 'a') && (c <= 'f')) cp |= c - 'a' + 10;
+    else if ((c >= 'A') && (c <= 'F')) cp |= c - 'A' + 10;
+    else return false;
+  }
+  return true;
+}
+
+} // namespace
+
+/**
+ * @brief Construct view on the whole document (trailing data is not allowed)
+ */
+JsonView::JsonView(string_view data)
+{
+  SScanner_t s(data);
+  Type type;
+  string_view raw;
+
+  if (s.scanValue(type, raw))
+  {
+    s.skipWs();
+    if (s.p == s.end)
+    {
+      mType = type;
+      mRaw  = raw;
+    }
+  }
+}
+
+/**
+ * @brief Check that data is a well-formed JSON document of the expected type
+ */
+bool JsonView::validate(string_view data, Type expected)
+{
+  return expected == JsonView(data).type();
+}
+
+/**
+ * @brief Find several object members in one pass
+ *
+ * @param[in] members  The list of member names with output views.
+ *                     Views of missed members are left untouched
+ *
+ * @return number of members found
+ */
+size_t JsonView::extract(std::initializer_list<Member_t> members) const
+{
+  size_t found = 0;
+
+  if (!isObject())
+  {
+    return found;
+  }
+
+  forEachMember(mRaw, [&members, &found] (string_view key, Type type, string_view raw)
+  {
+    for (const auto & m : members)
+    {
+      if (m.first == key)
+      {
+        m.second->mType = type;
+        m.second->mRaw  = raw;
+        ++found;
+        break;
+      }
+    }
+    return found < members.size();
+  });
+
+  return found;
+}
+
+/**
+ * @brief Get object member by key
+ *
+ * @return invalid view if the member is not found
+ */
+JsonView JsonView::get(string_view key) const
+{
+  JsonView rv;
+  extract({ { key, &rv } });
+  return rv;
+}
+
+/**
+ * @brief Get the first array item
+ *
+ * @return invalid view for empty array or non-array value
+ */
+JsonView JsonView::front() const
+{
+  JsonView rv;
+
+  if (!isArray())
+  {
+    return rv;
+  }
+
+  SScanner_t s(mRaw);
+  s.consume('[');
+  s.skipWs();
+  if ((s.p < s.end) && (']' != *s.p) && !s.scanValue(rv.mType, rv.mRaw))
+  {
+    rv = JsonView();
+  }
+
+  return rv;
+}
+
+/**
+ * @brief Get array item following the passed one
+ *
+ * @return invalid view after the last item
+ */
+JsonView JsonView::next(const JsonView & item) const
+{
+  JsonView rv;
+
+  if (!isArray() || !item.isValid())
+  {
+    return rv;
+  }
+
+  // string raw data does not include closing quote
+  const char * itemEnd = item.mRaw.data() + item.mRaw.size() + (item.isString() ? 1 : 0);
+
+  SScanner_t s(mRaw);
+  s.p = itemEnd;
+  if (s.consume(',') && !s.scanValue(rv.mType, rv.mRaw))
+  {
+    rv = JsonView();
+  }
+
+  return rv;
+}
+
+/**
+ * @brief Decode string value to the destination
+ *
+ * @param[out] out          The decoded value (cleared for non-string values)
+ * @param[in]  stripQuotes  Remove one leading and trailing quote from the value
+ *                          (compatibility with getJsonValue<string>)
+ *
+ * @return false if value is not a string or has invalid escape sequence
+ */
+bool JsonView::getString(string & out, bool stripQuotes) const
+{
+  out.clear();
+
+  if (!isString())
+  {
+    return false;
+  }
+
+  const char * p   = mRaw.data();
+  const char * end = mRaw.data() + mRaw.size();
+
+  // fast path: nothing to decode
+  if (string_view::npos == mRaw.find('\\'))
+  {
+    out.assign(p, end - p);
+  }
+  else
+  {
+    out.reserve(mRaw.size());
+
+    while (p < end)
+    {
+      char c = *p++;
+      if ('\\' != c)
+      {
+        out += c;
+        continue;
+      }
+
+      if (p >= end)
+      {
+        return false;
+      }
+
+      switch (c = *p++)
+      {
+        case '"':
+        case '\\':
+        case '/': out += c; break;
+        case 'b': out += '\b'; break;
+        case 'f': out += '\f'; break;
+        case 'n': out += '\n'; break;
+        case 'r': out += '\r'; break;
+        case 't': out += '\t'; break;
+        case 'u':
+        {
+          unsigned long cp;
+          if (!parseHex4(p, end, cp))
+          {
+            return false;
+          }
+          p += 4;
+
+          // surrogate pair
+          if ((cp >= 0xD800) && (cp <= 0xDBFF) &&
+              ((end - p) >= 6) && ('\\' == p[0]) && ('u' == p[1]))
+          {
+            unsigned long low;
+            if (parseHex4(p + 2, end, low) && (low >= 0xDC00) && (low <= 0xDFFF))
+            {
+              cp = 0x10000 + (((cp & 0x3FF) << 10) | (low & 0x3FF));
+              p += 6;
+            }
+          }
+
+          appendUtf8(out, cp);
+          break;
+        }
+        default:
+          return false;
+      }
+    }
+  }
+
+  if (stripQuotes && !out.empty())
+  {
+    if ('"' == out.front())
+    {
+      out.erase(out.begin());
+    }
+    if (!out.empty() && ('"' == out.back()))
+    {
+      out.pop_back();
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @brief Get integer part of the number value
+ *
+ * @return false if value is not a number
+ */
+bool JsonView::getInt(long & out) const
+{
+  if (!isNumber())
+  {
+    return false;
+  }
+
+  const char * p   = mRaw.data();
+  const char * end = mRaw.data() + mRaw.size();
+
+  bool negative = ('-' == *p);
+  if (negative)
+  {
+    ++p;
+  }
+
+  long value = 0;
+  while ((p < end) && (*p >= '0') && (*p <= '9'))
+  {
+    value = value * 10 + (*p++ - '0');
+  }
+
+  out = negative ? -value : value;
+  return true;
+}
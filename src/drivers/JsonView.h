@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <initializer_list>
+#include <utility>
+
+using std::string;
+using std::string_view;
+
+/**
+ * @brief Non-owning JSON value reader
+ *
+ * @note Points into the reply buffer and never allocates. Values are
+ *       located by a single forward scan which also validates the
+ *       structure of the skipped data. Strings keep escape sequences
+ *       until getString() decodes them into the destination
+ */
+class JsonView
+{
+  public:
+    enum Type
+    {
+      JSON_INVALID = 0,
+      JSON_NULL,
+      JSON_FALSE,
+      JSON_TRUE,
+      JSON_NUMBER,
+      JSON_STRING,
+      JSON_ARRAY,
+      JSON_OBJECT
+    };
+
+    // object member lookup for JsonView::extract
+    using Member_t = std::pair<string_view, JsonView *>;
+
+  private:
+    Type        mType = JSON_INVALID;
+    string_view mRaw;     // value bytes (string value without quotes)
+
+  public:
+    JsonView() = default;
+    explicit JsonView(string_view data);
+
+    static bool validate(string_view data, Type expected = JSON_OBJECT);
+
+    Type type() const         { return mType; }
+    bool isValid() const      { return JSON_INVALID != mType; }
+    bool isString() const     { return JSON_STRING == mType; }
+    bool isNumber() const     { return JSON_NUMBER == mType; }
+    bool isObject() const     { return JSON_OBJECT == mType; }
+    bool isArray() const      { return JSON_ARRAY == mType; }
+
+    // raw value bytes (for objects and arrays including brackets)
+    string_view raw() const   { return mRaw; }
+
+    size_t extract(std::initializer_list<Member_t> members) const;
+    JsonView get(string_view key) const;
+
+    JsonView front() const;
+    JsonView next(const JsonView & item) const;
+
+    bool getString(string & out, bool stripQuotes = false) const;
+    bool getInt(long & out) const;
+};
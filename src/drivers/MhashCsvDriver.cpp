@@ -2,6 +2,9 @@
 #include "resolver/Resolver.h"
 #include "MhashCsvDriver.h"
 
+#include <chrono>
+#include <unistd.h>
+
 /**************************************************************
  * Configuration implementation
 ***************************************************************/
@@ -66,6 +69,18 @@ CMhashCsvDriverCfg::CMhashCsvDriverCfg(const CDriverCfg::RawConfig_t & data)
         throw error(getLabel(), "invalid csv file path!");
       }
 
+      if (jData.has("batch_size"))
+      {
+        mBatchSize = static_cast<unsigned int> (jData["batch_size"]);
+      }
+      if (jData.has("batch_delay"))
+      {
+        mBatchDelay = static_cast<unsigned int> (jData["batch_delay"]);
+      }
+      if (jData.has("prefix_match"))
+      {
+        mPrefixMatch = static_cast<CfgFlag_t> (jData["prefix_match"]);
+      }
     }
     catch (std::exception & e)
     {
@@ -80,6 +95,8 @@ CMhashCsvDriverCfg::CMhashCsvDriverCfg(const CDriverCfg::RawConfig_t & data)
       throw error(getLabel(), "invalid csv file path!");
     }
   }
+
+  mDeltaFilePath = mFilePath + ".delta";
 }
 
 /**************************************************************
@@ -91,15 +108,16 @@ CMhashCsvDriverCfg::CMhashCsvDriverCfg(const CDriverCfg::RawConfig_t & data)
  * @param[in] data  The raw configuration data
  */
 CMhashCsvDriver::CMhashCsvDriver(const CDriverCfg::RawConfig_t & data)
-  :CDriver(ECDriverId::ERESOLVER_DRIVER_MHASH_CSV, "MHASH/CSV")
+  :CDriver(ECDriverId::ERESOLVER_DRIVER_MHASH_CSV, "MHASH/CSV"),
+   mGeneration(0),
+   mCancelReload(false)
 {
   mCfg.reset(new CMhashCsvDriverCfg(data));
 
   try
   {
-    mCsvHash.reset(new CCsvClient(mCfg->getFilePath(),
-                                  ECSV_FIELD_NUMBER,
-                                  ECSV_FIELD_MAX_VALUE));
+    load();
+    loadDelta();
   }
   catch (CCsvClient::error & e)
   {
@@ -107,17 +125,216 @@ CMhashCsvDriver::CMhashCsvDriver(const CDriverCfg::RawConfig_t & data)
   }
 }
 
+/**
+ * @brief Start the files watching
+ * @note Watchers are dispatcher event handlers, so they are created
+ *       on the dispatcher thread and not by the driver constructor
+ *       running on the loader thread
+ */
+void CMhashCsvDriver::activate()
+{
+  mWatcher.reset(new FileWatcher(mCfg->getFilePath(),
+                                 [this] { onFileChanged(ERELOAD_INDEX); }));
+  if (!mWatcher->is_watching())
+  {
+    warn("[%u/%s] could not watch file '%s', reload on change is disabled",
+         mCfg->getUniqId(), mCfg->getLabel(), mCfg->getFilePath());
+  }
+
+  mDeltaWatcher.reset(new FileWatcher(mCfg->getDeltaFilePath(),
+                                      [this] { onFileChanged(ERELOAD_DELTA); }));
+  if (!mDeltaWatcher->is_watching())
+  {
+    warn("[%u/%s] could not watch file '%s', delta updates are disabled",
+         mCfg->getUniqId(), mCfg->getLabel(), mCfg->getDeltaFilePath());
+  }
+}
+
+/**
+ * @brief Driver destructor (dispatcher thread)
+ * @note The background reload is cancelled, so the dispatcher waits
+ *       for the current parsing block or build stage only
+ */
+CMhashCsvDriver::~CMhashCsvDriver()
+{
+  mWatcher.reset();
+  mDeltaWatcher.reset();
+
+  mCancelReload = true;
+  if (mReloadThread.joinable())
+  {
+    mReloadThread.join();
+  }
+}
+
+/**
+ * @brief CSV rows layout of the index and delta files
+ */
+CCsvClient::SLayout_t CMhashCsvDriver::getLayout() const
+{
+  return { ECSV_FIELD_NUMBER,
+           ECSV_FIELD_ROUTING_TAG,
+           ECSV_FIELD_ROUTING_NUMBER,
+           ECSV_FIELD_MAX_VALUE,
+           mCfg->getPrefixMatch() };
+}
+
+/**
+ * @brief Build the index from the file and swap it with the current one
+ */
+void CMhashCsvDriver::load()
+{
+  auto startTime = std::chrono::steady_clock::now();
+
+  std::shared_ptr<const CCsvClient> index(
+    new CCsvClient(mCfg->getFilePath(), getLayout(), &mCancelReload));
+
+  std::chrono::duration<double, std::milli> elapsed =
+    std::chrono::steady_clock::now() - startTime;
+
+  std::atomic_store(&mCsvHash, index);
+  unsigned long generation = ++mGeneration;
+
+  index_loaded(generation, index->size(), index->memoryUsage(), elapsed.count());
+}
+
+/**
+ * @brief Build the delta from the file and swap it with the current one
+ * @note Missing delta file means no changes on top of the index
+ */
+void CMhashCsvDriver::loadDelta()
+{
+  const char * filePath = mCfg->getDeltaFilePath();
+
+  if (0 != access(filePath, F_OK))
+  {
+    std::atomic_store(&mCsvDelta, std::shared_ptr<const CCsvDelta>());
+    return;
+  }
+
+  auto startTime = std::chrono::steady_clock::now();
+
+  std::shared_ptr<const CCsvDelta> delta(
+    new CCsvDelta(filePath, getLayout()));
+
+  std::chrono::duration<double, std::milli> elapsed =
+    std::chrono::steady_clock::now() - startTime;
+
+  std::atomic_store(&mCsvDelta, delta);
+
+  info("[%u/%s] delta '%s' is applied: %zu upserts, %zu deletes, "
+       "%zu numbers changed, %.3f ms",
+       mCfg->getUniqId(), mCfg->getLabel(), filePath,
+       delta->upserts(), delta->deletes(), delta->size(), elapsed.count());
+}
+
+/**
+ * @brief File change notification handler (dispatcher thread)
+ * @note Changes during the reload are collapsed to the one more reload
+ *
+ * @param[in] target  The changed file (ERELOAD_INDEX or ERELOAD_DELTA)
+ */
+void CMhashCsvDriver::onFileChanged(unsigned int target)
+{
+  {
+    guard(mReloadMutex);
+    mReloadPending |= target;
+    if (mIsReloading)
+    {
+      return;
+    }
+    mIsReloading = true;
+  }
+
+  // previous reload thread is finished or about to finish
+  if (mReloadThread.joinable())
+  {
+    mReloadThread.join();
+  }
+
+  info("[%u/%s] file '%s' is changed, reloading",
+       mCfg->getUniqId(), mCfg->getLabel(),
+       (ERELOAD_INDEX & target) ? mCfg->getFilePath() : mCfg->getDeltaFilePath());
+
+  mReloadThread = std::thread(&CMhashCsvDriver::reload, this);
+}
+
+/**
+ * @brief Background reload procedure
+ * @note The current index and delta are kept on errors
+ */
+void CMhashCsvDriver::reload()
+{
+  for (;;)
+  {
+    unsigned int target;
+    {
+      guard(mReloadMutex);
+      target = mReloadPending;
+      mReloadPending = 0;
+      if (!target || mCancelReload)
+      {
+        mIsReloading = false;
+        return;
+      }
+    }
+
+    if (ERELOAD_INDEX & target)
+    {
+      try
+      {
+        load();
+        showInfo();
+      }
+      catch (std::exception & e)
+      {
+        if (mCancelReload)
+        {
+          info("[%u/%s] reload of file '%s' is cancelled",
+               mCfg->getUniqId(), mCfg->getLabel(), mCfg->getFilePath());
+          continue;
+        }
+        err("[%u/%s] failed to reload file '%s': %s. keep the current data",
+            mCfg->getUniqId(), mCfg->getLabel(), mCfg->getFilePath(), e.what());
+      }
+    }
+
+    if (ERELOAD_DELTA & target)
+    {
+      try
+      {
+        loadDelta();
+      }
+      catch (std::exception & e)
+      {
+        err("[%u/%s] failed to reload file '%s': %s. keep the current delta",
+            mCfg->getUniqId(), mCfg->getLabel(), mCfg->getDeltaFilePath(), e.what());
+      }
+    }
+  }
+}
+
 /**
  * @brief Show drive information
  */
 void CMhashCsvDriver::showInfo() const
 {
-  info("[%u/%s] '%s' driver => file '%s' "
-       "[hash size - %zu items]",
+  auto csvHash = std::atomic_load(&mCsvHash);
+  auto csvDelta = std::atomic_load(&mCsvDelta);
+
+  info("[%u/%s] '%s' driver => %s file '%s' "
+       "[hash size - %zu items, %zu prefixes, %zu tags, %zu bytes, generation %lu, "
+       "delta %zu items]",
        mCfg->getUniqId(),
        mCfg->getLabel(), getName(),
+       csvHash->isSnapshot() ? "snapshot" : "CSV",
        mCfg->getFilePath(),
-       mCsvHash->size());
+       csvHash->size(),
+       csvHash->prefixesCount(),
+       csvHash->tagsCount(),
+       csvHash->memoryUsage(),
+       mGeneration.load(),
+       csvDelta ? csvDelta->size() : 0);
 }
 
 /**
@@ -134,22 +351,44 @@ void CMhashCsvDriver::resolve(ResolverRequest &request,
 
     dbg("resolving by in-memory search for number '%s'", request.data.c_str());
 
+    // keeps the index alive if it is swapped by reload meanwhile
+    auto csvHash = std::atomic_load(&mCsvHash);
+    auto csvDelta = std::atomic_load(&mCsvDelta);
+
     try
     {
-        const CCsvClient::row_t * csvRow = mCsvHash->perform(request.data);
+        // delta changes take precedence over the index
+        CCsvDelta::EResult_t deltaResult = CCsvDelta::EDELTA_NOT_FOUND;
+        if (csvDelta)
+        {
+            deltaResult = csvDelta->perform(request.data,
+                                            request.result.localRoutingNumber,
+                                            request.result.localRoutingTag);
+        }
 
-        if (!csvRow) {
+        bool isFound = (CCsvDelta::EDELTA_FOUND == deltaResult);
+        if (CCsvDelta::EDELTA_NOT_FOUND == deltaResult)
+        {
+            isFound = csvHash->perform(request.data,
+                                       request.result.localRoutingNumber,
+                                       request.result.localRoutingTag);
+        }
+        else if (CCsvDelta::EDELTA_DELETED == deltaResult)
+        {
+            // deleted row of the number, its prefix is still applicable
+            isFound = csvHash->performPrefix(request.data,
+                                             request.result.localRoutingNumber,
+                                             request.result.localRoutingTag);
+        }
+
+        if (!isFound)
+        {
             //TODO: check if this logic required
             dbg("number '%s' not found in hash. Set out to input data with epty tag",
             request.data.c_str());
 
             request.result.localRoutingNumber = request.data;
         }
-        else
-        {
-            request.result.localRoutingNumber = csvRow->field[ECSV_FIELD_ROUTING_NUMBER];
-            request.result.localRoutingTag    = csvRow->field[ECSV_FIELD_ROUTING_TAG];
-        }
     }
     catch (CCsvClient::error & e) {
         throw error(e.what());
@@ -158,5 +397,67 @@ void CMhashCsvDriver::resolve(ResolverRequest &request,
     request.is_done = true;
 }
 
+/**
+ * @brief Executing batch resolving procedure
+ * @note Numbers not changed by the delta are looked up in the index
+ *       by one batch, so memory misses of the lookups overlap
+ */
+void CMhashCsvDriver::resolve_batch(vector<ResolverRequest> &requests,
+                                    Resolver *,
+                                    ResolverHandler *) const
+{
+    dbg("resolving by in-memory batch search for %zu numbers", requests.size());
+
+    auto csvHash = std::atomic_load(&mCsvHash);
+    auto csvDelta = std::atomic_load(&mCsvDelta);
+
+    vector<CCsvClient::SLookup_t> lookups;
+    vector<ResolverRequest *> pending;
+    lookups.reserve(requests.size());
+    pending.reserve(requests.size());
+
+    for (auto &request : requests)
+    {
+        CCsvDelta::EResult_t deltaResult = CCsvDelta::EDELTA_NOT_FOUND;
+        if (csvDelta)
+        {
+            deltaResult = csvDelta->perform(request.data,
+                                            request.result.localRoutingNumber,
+                                            request.result.localRoutingTag);
+        }
+
+        if (CCsvDelta::EDELTA_NOT_FOUND == deltaResult)
+        {
+            lookups.push_back({ &request.data,
+                                &request.result.localRoutingNumber,
+                                &request.result.localRoutingTag,
+                                false });
+            pending.push_back(&request);
+        }
+        else if (CCsvDelta::EDELTA_DELETED == deltaResult)
+        {
+            // deleted row of the number, its prefix is still applicable
+            if (!csvHash->performPrefix(request.data,
+                                        request.result.localRoutingNumber,
+                                        request.result.localRoutingTag))
+            {
+                request.result.localRoutingNumber = request.data;
+            }
+        }
+
+        request.is_done = true;
+    }
+
+    csvHash->performBatch(lookups.data(), lookups.size());
+
+    for (size_t i = 0; i < lookups.size(); ++i)
+    {
+        if (!lookups[i].isFound)
+        {
+            pending[i]->result.localRoutingNumber = pending[i]->data;
+        }
+    }
+}
+
 void CMhashCsvDriver::parse(const string &data, ResolverRequest &request) const {
 }
@@ -3,6 +3,13 @@
 
 #include "Driver.h"
 #include "drivers/modules/CsvClient.h"
+#include "drivers/modules/CsvDelta.h"
+#include "dispatcher/FileWatcher.h"
+#include "thread.h"
+
+#include <memory>
+#include <thread>
+#include <atomic>
 
 /**
  * @brief Driver configuration class
@@ -11,6 +18,10 @@ class CMhashCsvDriverCfg: public CDriverCfg
 {
   private:
     CfgFilePath_t mFilePath;
+    CfgFilePath_t mDeltaFilePath;
+    unsigned int  mBatchSize  = 0;   // numbers per batch lookup, 0/1 - disabled
+    unsigned int  mBatchDelay = 0;   // max batch collecting time (milliseconds)
+    bool          mPrefixMatch = false;   // numbers ending by '*' are prefixes
 
     // Driver specific getters for war configuration processing
     static const CfgFilePath_t getRawFilePath(const RawConfig_t & data);
@@ -21,6 +32,10 @@ class CMhashCsvDriverCfg: public CDriverCfg
     ~CMhashCsvDriverCfg() override = default;
 
     const char * getFilePath() const  { return mFilePath.c_str(); }
+    const char * getDeltaFilePath() const  { return mDeltaFilePath.c_str(); }
+    unsigned int getBatchSize() const  { return mBatchSize; }
+    unsigned int getBatchDelay() const { return mBatchDelay; }
+    bool getPrefixMatch() const { return mPrefixMatch; }
 };
 
 /**
@@ -28,6 +43,24 @@ class CMhashCsvDriverCfg: public CDriverCfg
  *
  * @note Supported tag result field! But raw
  *       field will not used for this driver!
+ *       The file could be either CSV or the binary snapshot
+ *       compiled by yeti_lnp_csv_compile (detected by the header).
+ *       The file is watched for changes (since the driver activation)
+ *       and the new index is built in background. Lookups in progress keep the old index alive
+ *       until they finish. The file must be replaced by rename only
+ *       (written under the temporary name, as CCsvClient::save() does):
+ *       it is used from the shared mapping, so the in-place rewrite
+ *       could crash the process and is not detected as the change.
+ *       With the optional 'prefix_match' parameter rows with
+ *       the number ending by '*' are prefixes matched by the longest
+ *       one (see CCsvClient), otherwise '*' is the part of the number.
+ *       Optional 'batch_size' and 'batch_delay' parameters enable
+ *       collecting of requests for the batch lookup with prefetching.
+ *       Changes could be published without the full rebuild in the
+ *       delta file ('<file>.delta', see CCsvDelta for the format).
+ *       Delta is applied on top of the index and rebuilt in background
+ *       on change as well (replaced by rename too). Replace it by
+ *       the empty one when the full file is updated
  */
 class CMhashCsvDriver: public CDriver
 {
@@ -43,18 +76,49 @@ class CMhashCsvDriver: public CDriver
 
   private:
     unique_ptr<CMhashCsvDriverCfg> mCfg;
-    unique_ptr<CCsvClient> mCsvHash;
+    std::shared_ptr<const CCsvClient> mCsvHash;   // accessed atomically
+    std::shared_ptr<const CCsvDelta> mCsvDelta;   // accessed atomically, could be empty
+    std::atomic<unsigned long> mGeneration;
+
+    // Reload targets
+    enum EReload_t : unsigned int
+    {
+       ERELOAD_INDEX = 0x01
+      ,ERELOAD_DELTA = 0x02
+    };
+
+    // Background reload state
+    unique_ptr<FileWatcher> mWatcher;
+    unique_ptr<FileWatcher> mDeltaWatcher;
+    std::thread mReloadThread;
+    mutex mReloadMutex;
+    bool mIsReloading = false;
+    unsigned int mReloadPending = 0;
+    std::atomic<bool> mCancelReload;
+
+    CCsvClient::SLayout_t getLayout() const;
+    void load();
+    void loadDelta();
+    void onFileChanged(unsigned int target);
+    void reload();
 
   public:
     explicit CMhashCsvDriver(const CDriverCfg::RawConfig_t & data);
-    ~CMhashCsvDriver() override = default;
+    ~CMhashCsvDriver() override;
 
     void showInfo() const override;
+    void activate() override;
     void resolve(ResolverRequest &request,
                  Resolver *resolver,
                  ResolverHandler *handler) const override;
     void parse(const string &data, ResolverRequest &request) const override;
 
+    unsigned int getBatchSize() const override  { return mCfg->getBatchSize(); }
+    unsigned int getBatchDelay() const override { return mCfg->getBatchDelay(); }
+    void resolve_batch(vector<ResolverRequest> &requests,
+                       Resolver *resolver,
+                       ResolverHandler *handler) const override;
+
     const CDriverCfg::CfgUniqId_t getUniqueId() const override
                                                 { return mCfg->getUniqId(); }
 };
@@ -0,0 +1,226 @@
+#include "RawConfig.h"
+#include "libs/cJSON.h"
+
+#include <memory>
+#include <functional>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using cJSONPtr_t = std::unique_ptr<cJSON, void(*)(cJSON*)>;
+
+// JSON number keeps integers exactly up to 2^53
+static const double maxExactInteger = 9007199254740992.0;
+
+/**
+ * @brief Add column value
+ */
+void CRawConfig::add(const string & name, const string & value)
+{
+  mColumns.push_back({ name, value, false });
+}
+
+/**
+ * @brief Add column with null value
+ */
+void CRawConfig::addNull(const string & name)
+{
+  mColumns.push_back({ name, string(), true });
+}
+
+/**
+ * @brief Column accessor
+ *
+ * @param[in] name  The column name
+ *
+ * @return column value
+ */
+CRawConfig::CField CRawConfig::operator[](const char * name) const
+{
+  for (const auto & c : mColumns)
+  {
+    if (c.name == name)
+    {
+      return CField(name, c.isNull ? nullptr : &c.value);
+    }
+  }
+
+  throw error("column '%s' is not found", name);
+}
+
+/**
+ * @brief Configuration hash
+ *
+ * @note Equal for the same columns in the same order, so the driver
+ *       could be kept as is when its load_lnp_databases() row is not
+ *       changed between the reloads
+ *
+ * @return hash value
+ */
+size_t CRawConfig::hash() const
+{
+  std::hash<string> hasher;
+  size_t rv = mColumns.size();
+
+  auto combine = [&rv] (size_t v)
+    { rv ^= v + 0x9e3779b97f4a7c15ULL + (rv << 6) + (rv >> 2); };
+
+  for (const auto & c : mColumns)
+  {
+    combine(hasher(c.name));
+    combine(c.isNull ? 0 : hasher(c.value) + 1);
+  }
+
+  return rv;
+}
+
+/**
+ * @brief Load configurations from the JSON file
+ *
+ * @note The file is the array of objects with the columns of
+ *       load_lnp_databases() as keys. Values are expected as strings
+ *       (see saveFile()), hand written objects and arrays values
+ *       (e.g. 'parameters') and numbers are converted to JSON strings
+ *
+ * @param[in] filePath  The file path
+ *
+ * @return configurations list
+ */
+vector<CRawConfig> CRawConfig::loadFile(const char * filePath)
+{
+  std::ifstream f(filePath);
+  if (!f)
+  {
+    throw error("can't open file '%s'", filePath);
+  }
+
+  std::stringstream buf;
+  buf << f.rdbuf();
+
+  cJSONPtr_t root(cJSON_Parse(buf.str().c_str()), cJSON_Delete);
+  if (!root || !cJSON_IsArray(root.get()))
+  {
+    throw error("file '%s' is not the JSON array", filePath);
+  }
+
+  vector<CRawConfig> rv;
+  for (cJSON * item = root->child; item; item = item->next)
+  {
+    if (!cJSON_IsObject(item))
+    {
+      throw error("file '%s': array item is not the object", filePath);
+    }
+
+    CRawConfig cfg;
+    for (cJSON * c = item->child; c; c = c->next)
+    {
+      if (cJSON_IsNull(c))
+      {
+        cfg.addNull(c->string);
+      }
+      else if (cJSON_IsString(c))
+      {
+        cfg.add(c->string, c->valuestring);
+      }
+      else if (cJSON_IsBool(c))
+      {
+        // PostgreSQL boolean text representation
+        cfg.add(c->string, cJSON_IsTrue(c) ? "t" : "f");
+      }
+      else if (cJSON_IsNumber(c) && (std::floor(c->valuedouble) == c->valuedouble) &&
+               (std::fabs(c->valuedouble) <= maxExactInteger))
+      {
+        cfg.add(c->string, std::to_string(static_cast<long long>(c->valuedouble)));
+      }
+      else
+      {
+        std::unique_ptr<char, void(*)(void*)> str(cJSON_PrintUnformatted(c), free);
+        cfg.add(c->string, str ? str.get() : "");
+      }
+    }
+    rv.push_back(std::move(cfg));
+  }
+
+  return rv;
+}
+
+/**
+ * @brief Save configurations to the JSON file
+ *
+ * @note Values are saved as JSON strings exactly as they are, so the
+ *       loaded configurations have the same hash as the database ones
+ *       (no numbers precision loss or 'parameters' reformatting). The
+ *       file holds provider credentials, it is created readable by the
+ *       owner only and replaced atomically after the data is synced
+ *
+ * @param[in] filePath  The file path
+ * @param[in] configs   The configurations list
+ */
+void CRawConfig::saveFile(const char * filePath, const vector<CRawConfig> & configs)
+{
+  cJSONPtr_t root(cJSON_CreateArray(), cJSON_Delete);
+
+  for (const auto & cfg : configs)
+  {
+    cJSON * item = cJSON_CreateObject();
+    cJSON_AddItemToArray(root.get(), item);
+
+    for (const auto & c : cfg.columns())
+    {
+      cJSON_AddItemToObject(item, c.name.c_str(),
+                            c.isNull ? cJSON_CreateNull() : cJSON_CreateString(c.value.c_str()));
+    }
+  }
+
+  std::unique_ptr<char, void(*)(void*)> str(cJSON_Print(root.get()), free);
+  if (!str)
+  {
+    throw error("can't format configuration");
+  }
+
+  // stale file of the failed save is replaced, not reused with its mode
+  string tmpPath = string(filePath) + ".tmp";
+  unlink(tmpPath.c_str());
+
+  int fd = open(tmpPath.c_str(), O_CREAT | O_EXCL | O_WRONLY | O_CLOEXEC, 0600);
+  if (fd < 0)
+  {
+    throw error("can't create file '%s': %s", tmpPath.c_str(), strerror(errno));
+  }
+
+  string data(str.get());
+  data += '\n';
+
+  bool ok = true;
+  for (size_t written = 0; ok && written < data.size();)
+  {
+    ssize_t n = write(fd, data.data() + written, data.size() - written);
+    if (n < 0 && EINTR == errno)
+    {
+      continue;
+    }
+    ok = (n > 0);
+    written += ok ? n : 0;
+  }
+  ok = ok && (0 == fsync(fd));
+
+  int e = errno;
+  ok = (0 == close(fd)) && ok;
+  if (!ok)
+  {
+    unlink(tmpPath.c_str());
+    throw error("can't write file '%s': %s", tmpPath.c_str(), strerror(e));
+  }
+
+  if (0 != std::rename(tmpPath.c_str(), filePath))
+  {
+    e = errno;
+    unlink(tmpPath.c_str());
+    throw error("can't replace file '%s': %s", filePath, strerror(e));
+  }
+}
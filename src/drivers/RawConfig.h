@@ -0,0 +1,121 @@
+#ifndef SERVER_SRC_DRIVERS_RAWCONFIG_H_
+#define SERVER_SRC_DRIVERS_RAWCONFIG_H_
+
+#include <stdexcept>
+using std::runtime_error;
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include <cstdlib>
+#include <cerrno>
+#include <type_traits>
+
+#include "libs/fmterror.h"
+
+/**
+ * @brief Driver configuration record independent of the source
+ *
+ * @note Keeps the named columns of one load_lnp_databases() row or
+ *       one object of the local JSON configuration file. Field access
+ *       follows pqxx::row interface used by the drivers: missed column
+ *       throws CRawConfig::error, null value gives the default one
+ */
+class CRawConfig
+{
+  public:
+    // Raw configuration exception class
+    class error : public runtime_error
+    {
+      public:
+        template <typename ... Args>
+        explicit error(const char * fmt, Args ... args) :
+          runtime_error(fmterror(fmt, args ...).get()) { }
+    };
+
+    // Column value
+    class CField
+    {
+      private:
+        const char * mName;
+        const string * mValue;   // null for SQL NULL
+
+        template <typename T>
+        typename std::enable_if<std::is_integral<T>::value, T>::type
+        convert() const
+        {
+          char * end = nullptr;
+          errno = 0;
+          long long v = std::strtoll(mValue->c_str(), &end, 10);
+          if (errno || end == mValue->c_str() || *end)
+          {
+            throw error("column '%s': '%s' is not an integer",
+                        mName, mValue->c_str());
+          }
+          return static_cast<T>(v);
+        }
+
+        template <typename T>
+        typename std::enable_if<std::is_same<T, string>::value, T>::type
+        convert() const
+        {
+          return *mValue;
+        }
+
+      public:
+        CField(const char * name, const string * value) :
+          mName(name), mValue(value) { }
+
+        bool isNull() const { return nullptr == mValue; }
+
+        // non-zero for the present column as pqxx field type oid
+        int type() const { return 1; }
+
+        const char * c_str() const { return mValue ? mValue->c_str() : ""; }
+
+        template <typename T>
+        T as() const
+        {
+          if (!mValue)
+          {
+            throw error("column '%s' is null", mName);
+          }
+          return convert<T>();
+        }
+
+        template <typename T>
+        T as(const T & def) const
+        {
+          return mValue ? convert<T>() : def;
+        }
+    };
+
+    void add(const string & name, const string & value);
+    void addNull(const string & name);
+
+    CField operator[](const char * name) const;
+
+    // Named column value
+    struct SColumn_t
+    {
+      string name;
+      string value;
+      bool   isNull;
+    };
+
+    const vector<SColumn_t> & columns() const { return mColumns; }
+
+    // hash of the columns names and values to detect the changes
+    size_t hash() const;
+
+    static vector<CRawConfig> loadFile(const char * filePath);
+    static void saveFile(const char * filePath, const vector<CRawConfig> & configs);
+
+  private:
+    vector<SColumn_t> mColumns;
+};
+
+#endif /* SERVER_SRC_DRIVERS_RAWCONFIG_H_ */
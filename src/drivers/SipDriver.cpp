@@ -1,6 +1,6 @@
 #include <sstream>
-#include <vector>
-using std::vector;
+#include <string_view>
+using std::string_view;
 
 #include "log.h"
 #include "cfg.h"
@@ -11,20 +11,36 @@ using std::vector;
  * Implementation helpers
 ***************************************************************/
 /**
- * @brief Split string by delimiter and save results to vector
+ * @brief Find value of the parameter in ';' separated list
+ *
+ * @note Scans the list in place without splitting it to the tokens.
+ *       Parameters with empty value or extra '=' are skipped
+ *
+ * @return true if the parameter is found
  */
-vector<string> split(const string & inStr, const char delimiter)
+static bool findUriParam(string_view params, string_view name, string_view & value)
 {
-  vector<string> rv;
-  std::istringstream inStream(inStr);
-  string token;
-
-  while (std::getline(inStream, token, delimiter))
+  while (!params.empty())
   {
-    rv.push_back(token);
+    size_t delim = params.find(';');
+    string_view elm = params.substr(0, delim);
+    params = (string_view::npos == delim) ? string_view() : params.substr(delim + 1);
+
+    size_t eq = elm.find('=');
+    if ((string_view::npos == eq) || (elm.substr(0, eq) != name))
+    {
+      continue;
+    }
+
+    string_view v = elm.substr(eq + 1);
+    if (!v.empty() && (string_view::npos == v.find('=')))
+    {
+      value = v;
+      return true;
+    }
   }
 
-  return rv;
+  return false;
 }
 
 /**************************************************************
@@ -222,28 +238,14 @@ void CSipDriver::parse(const string &data, ResolverRequest &request) const {
         return;
     }
 
-    vector<string> uriElements = split(data, ';');
-    // Parse elements to name and value
-    bool isValueFound = false;
-    for (const auto & i : uriElements)
-    {
-        // elm[0] = name
-        // elm[1] = value
-        vector<string> elm = split(i, '=');
-        if ((2 == elm.size()) && ("rn" == elm[0]))
-        {
-            // rn=<local_routing_number>
-            request.result.localRoutingNumber = elm[1];
-            isValueFound           = true;
-
-            break;
-        }
-    }
-
-    if (!isValueFound)
+    // rn=<local_routing_number>
+    string_view lrn;
+    if (!findUriParam(data, "rn", lrn))
     {
         throw error("Сontact user without 'rn' parameter");
     }
 
+    request.result.localRoutingNumber.assign(lrn.data(), lrn.size());
+
     request.result.rawData = data;
 }
@@ -9,11 +9,13 @@
 #include <memory>
 
 #include "log.h"
+#include "cfg.h"
 
 /* Information associated with a specific easy handle */
 
 typedef struct ConnInfo {
     uint32_t id;
+    HttpRequestType type;
     AsyncHttpClient *http_client;
     CURL *easy;
     struct curl_slist *header_list;
@@ -56,6 +58,38 @@ static size_t write_cb_static(void *ptr, size_t size, size_t nmemb, ConnInfo *co
     return append_size;
 }
 
+/* HttpConnOptions */
+
+void HttpConnOptions::parse(cJSON &j)
+{
+    if (j.type != cJSON_Object)
+        throw std::runtime_error("HttpConnOptions::parse: JSON object expected");
+
+    auto get_number = [&j](const char *key, long &value) {
+        auto item = cJSON_GetObjectItem(&j, key);
+        if (!item)
+            return;
+        if (item->type != cJSON_Number || item->valueint < 0)
+            throw std::runtime_error(string("HttpConnOptions::parse: invalid value for ") + key);
+        value = item->valueint;
+    };
+
+    if (auto item = cJSON_GetObjectItem(&j, "http2")) {
+        if (item->type != cJSON_True && item->type != cJSON_False)
+            throw std::runtime_error("HttpConnOptions::parse: invalid value for http2");
+        http2 = (item->type == cJSON_True);
+    }
+
+    get_number("keepalive_idle", keepalive_idle);
+    get_number("keepalive_interval", keepalive_interval);
+    get_number("max_idle_time", max_idle_time);
+    get_number("keep_warm_interval", keep_warm_interval);
+
+    long warm = warm_connections;
+    get_number("warm_connections", warm);
+    warm_connections = static_cast<unsigned int>(warm);
+}
+
 /* HttpClient */
 
 AsyncHttpClient::AsyncHttpClient(AsyncHttpClientHandler *http_handler)
@@ -63,15 +97,48 @@ AsyncHttpClient::AsyncHttpClient(AsyncHttpClientHandler *http_handler)
 {
     init_timer();
     init_respose_notifier();
+    init_share();
     multi = curl_multi_init();
     curl_multi_setopt(multi, CURLMOPT_SOCKETFUNCTION, socket_cb_static);
     curl_multi_setopt(multi, CURLMOPT_SOCKETDATA, this);
     curl_multi_setopt(multi, CURLMOPT_TIMERFUNCTION, timer_cb_static);
     curl_multi_setopt(multi, CURLMOPT_TIMERDATA, this);
+    init_multi_options();
+}
+
+/* connection pool options shared by all drivers */
+
+void AsyncHttpClient::init_multi_options() {
+    const auto &http = cfg.http;
+
+    curl_multi_setopt(multi, CURLMOPT_PIPELINING,
+                      http.multiplexing ? CURLPIPE_MULTIPLEX : CURLPIPE_NOTHING);
+
+    if (http.max_host_connections)
+        curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS,
+                          static_cast<long>(http.max_host_connections));
+
+    if (http.max_total_connections)
+        curl_multi_setopt(multi, CURLMOPT_MAX_TOTAL_CONNECTIONS,
+                          static_cast<long>(http.max_total_connections));
+
+    if (http.max_cached_connections)
+        curl_multi_setopt(multi, CURLMOPT_MAXCONNECTS,
+                          static_cast<long>(http.max_cached_connections));
+
+    if (http.max_concurrent_streams)
+        curl_multi_setopt(multi, CURLMOPT_MAX_CONCURRENT_STREAMS,
+                          static_cast<long>(http.max_concurrent_streams));
+
+    dbg("multi options: multiplexing:%d, max_host_connections:%u, "
+        "max_total_connections:%u, max_cached_connections:%u, max_concurrent_streams:%u",
+        http.multiplexing, http.max_host_connections, http.max_total_connections,
+        http.max_cached_connections, http.max_concurrent_streams);
 }
 
 AsyncHttpClient::~AsyncHttpClient() {
     curl_multi_cleanup(multi);
+    curl_share_cleanup(share);
 
     if (respose_notifier_fd >= 0) {
         unlink(respose_notifier_fd);
@@ -84,6 +151,20 @@ AsyncHttpClient::~AsyncHttpClient() {
     }
 }
 
+/* TLS sessions shared by all easy handles. DNS and connection caches are
+ * already shared by the multi handle. All handles are driven by the multi
+ * handle on the dispatcher thread, so the share needs no lock callbacks */
+
+void AsyncHttpClient::init_share() {
+    share = curl_share_init();
+    if (!share) {
+        err("share creation error");
+        return;
+    }
+
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+}
+
 /* request */
 
 int AsyncHttpClient::make_request(const HttpRequest &request) {
@@ -109,6 +190,7 @@ int AsyncHttpClient::make_request(const HttpRequest &request) {
 
     conn->http_client = this;
     conn->id = request.id;
+    conn->type = request.type;
     conn->easy = easy;
     conn->error[0]='\0';
 
@@ -121,6 +203,21 @@ int AsyncHttpClient::make_request(const HttpRequest &request) {
         }
     }
 
+    // method
+    if (request.method == HEAD &&
+        CURLE_OK != curl_easy_setopt(easy, CURLOPT_NOBODY, 1L)) {
+        free_conn_info();
+        throw error("request method processing error");
+    }
+
+    // shared caches
+    if ((share && CURLE_OK != curl_easy_setopt(easy, CURLOPT_SHARE, share)) ||
+        (CURLE_OK != curl_easy_setopt(easy, CURLOPT_DNS_CACHE_TIMEOUT,
+                                      static_cast<long>(cfg.http.dns_cache_timeout)))) {
+        free_conn_info();
+        throw error("shared cache option error");
+    }
+
     // ssl
     const bool verify_ssl = request.verify_ssl;
     const long verify = verify_ssl ? 2L : 0L;
@@ -156,6 +253,34 @@ int AsyncHttpClient::make_request(const HttpRequest &request) {
         throw error("set up timeout value error");
     }
 
+    // connection reuse. Probes do not wait for multiplexing, otherwise
+    // all of them would share one HTTP/2 connection instead of warming up
+    // 'warm_connections' ones
+    if (const HttpConnOptions *opts = request.conn_opts) {
+        const long pipewait = (request.type != HTTP_REQUEST_PROBE) ? 1L : 0L;
+        if (opts->http2 &&
+            ((CURLE_OK != curl_easy_setopt(easy, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS)) ||
+             (CURLE_OK != curl_easy_setopt(easy, CURLOPT_PIPEWAIT, pipewait)))) {
+            free_conn_info();
+            throw error("HTTP/2 option error");
+        }
+
+        if (opts->keepalive_idle &&
+            ((CURLE_OK != curl_easy_setopt(easy, CURLOPT_TCP_KEEPALIVE, 1L)) ||
+             (CURLE_OK != curl_easy_setopt(easy, CURLOPT_TCP_KEEPIDLE, opts->keepalive_idle)) ||
+             (opts->keepalive_interval &&
+              CURLE_OK != curl_easy_setopt(easy, CURLOPT_TCP_KEEPINTVL, opts->keepalive_interval)))) {
+            free_conn_info();
+            throw error("TCP keep-alive option error");
+        }
+
+        if (opts->max_idle_time &&
+            CURLE_OK != curl_easy_setopt(easy, CURLOPT_MAXAGE_CONN, opts->max_idle_time)) {
+            free_conn_info();
+            throw error("connection idle time option error");
+        }
+    }
+
     // headers
     struct curl_slist *header_list = nullptr;
     for (const auto & header : request.headers) {
@@ -213,6 +338,33 @@ int AsyncHttpClient::make_request(const HttpRequest &request) {
     return 0;
 }
 
+/* scheme://host[:port]/ part of the url, used as keep-warm probe target */
+
+string AsyncHttpClient::get_origin_url(const string &url) {
+    string ret;
+    CURLU *u = curl_url();
+    if (!u)
+        return ret;
+
+    char *scheme = nullptr, *host = nullptr, *port = nullptr;
+    if (CURLUE_OK == curl_url_set(u, CURLUPART_URL, url.c_str(), 0) &&
+        CURLUE_OK == curl_url_get(u, CURLUPART_SCHEME, &scheme, 0) &&
+        CURLUE_OK == curl_url_get(u, CURLUPART_HOST, &host, 0))
+    {
+        ret = string(scheme) + "://" + host;
+        if (CURLUE_OK == curl_url_get(u, CURLUPART_PORT, &port, 0))
+            ret += string(":") + port;
+        ret += "/";
+    }
+
+    curl_free(scheme);
+    curl_free(host);
+    curl_free(port);
+    curl_url_cleanup(u);
+
+    return ret;
+}
+
 /* callbacks */
 
 int AsyncHttpClient::socket_cb(CURL *easy, curl_socket_t sock_fd, int what, SockInfo *sock_info) {
@@ -265,6 +417,19 @@ void AsyncHttpClient::check_multi_info() {
         auto response = make_unique<HttpResponse>();
         response->id = conn->id;
 
+        long new_connects = 0;
+        curl_easy_getinfo(easy, CURLINFO_NUM_CONNECTS, &new_connects);
+        char *primary_ip = nullptr;
+        curl_easy_getinfo(easy, CURLINFO_PRIMARY_IP, &primary_ip);
+        response->is_connection_used = primary_ip && *primary_ip;
+        response->is_connection_reused =
+            response->is_connection_used && (new_connects == 0);
+        response->type = conn->type;
+
+        curl_off_t total_time = 0;
+        curl_easy_getinfo(easy, CURLINFO_TOTAL_TIME_T, &total_time);
+        response->total_time_ms = total_time / 1000.0;
+
         if (res == CURLE_OK) {
             response->is_success = true;
             response->data = conn->response;
@@ -2,6 +2,7 @@
 
 #include "dispatcher/EventHandler.h"
 #include "libs/fmterror.h"
+#include "libs/cJSON.h"
 
 #include <string>
 #include <memory>
@@ -16,7 +17,15 @@ class AsyncHttpClient;
 struct SockInfo;
 
 enum HttpMethod {
-    GET
+    GET,
+    HEAD
+};
+
+// Request purpose, defines the meaning of the request id
+enum HttpRequestType {
+    HTTP_REQUEST_SINGLE,    // id is a resolver request id
+    HTTP_REQUEST_BATCH,     // id is a batch sequence number
+    HTTP_REQUEST_PROBE      // id is a driver unique id
 };
 
 // Authorization enumerations
@@ -25,6 +34,24 @@ enum class ECAuth : uint8_t {
     BASIC = CURLAUTH_BASIC
 };
 
+/**
+ * @brief Per-driver connection reuse options
+ *
+ * @note applied to each easy handle. Pool limits are
+ *       global for the multi handle (see 'http' config section)
+ */
+struct HttpConnOptions {
+    bool http2 = false;             // negotiate HTTP/2 and multiplex over one connection
+    long keepalive_idle = 0;        // TCP keep-alive idle time (seconds), 0 - disabled
+    long keepalive_interval = 0;    // TCP keep-alive probes interval (seconds)
+    long max_idle_time = 0;         // drop cached connection idle longer (seconds), 0 - curl default
+    unsigned int warm_connections = 0; // connections opened by probes after (re)configuration
+    long keep_warm_interval = 0;    // probes repeat interval (seconds), 0 - warm up once
+    bool verify_ssl = false;        // driver TLS certificate verification, used by probes (not parsed)
+
+    void parse(cJSON &j);
+};
+
 struct HttpRequest {
     uint32_t id = -1;
     HttpMethod method = GET;
@@ -35,11 +62,17 @@ struct HttpRequest {
     bool verify_ssl = false;
     long timeout_ms = 0;
     vector<const char *> headers;
+    const HttpConnOptions *conn_opts = nullptr;
+    HttpRequestType type = HTTP_REQUEST_SINGLE;
 };
 
 struct HttpResponse {
     uint32_t id = -1;
     bool is_success = false;
+    bool is_connection_used = false;    // false if connect is failed
+    bool is_connection_reused = false;
+    HttpRequestType type = HTTP_REQUEST_SINGLE;
+    double total_time_ms = 0;
     string data;
 };
 
@@ -74,6 +107,8 @@ public:
 
     int make_request(const HttpRequest &request);
 
+    static string get_origin_url(const string &url);
+
     int socket_cb(CURL *easy, curl_socket_t sock_fd, int what, SockInfo *sock_info);
     int timer_cb(CURLM *multi, long timeout_ms);
 
@@ -81,6 +116,8 @@ public:
     int handle_event(int fd, uint32_t events, bool &stop) override;
 
 protected:
+    void init_multi_options();
+    void init_share();
     void check_multi_info();
 
     /* sockets */
@@ -106,5 +143,6 @@ private:
     int timer_fd = -1;
     int still_running;
     CURLM *multi;
+    CURLSH *share;
     AsyncHttpClientHandler *handler;
 };
@@ -1,125 +1,1643 @@
-#include <fstream>
-#include <sstream>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <cstdio>
+#include <cstddef>
 
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <zlib.h>
+#ifdef WITH_ZSTD
+#include <zstd.h>
+#endif
+
+#include "log.h"
 #include "CsvClient.h"
 
+using std::string_view;
+
+/**************************************************************
+ * Implementation helpers
+***************************************************************/
+namespace
+{
+
+// Packed number: decimal value of up to 15 digits (50 bits) with
+// the digits count in the low nibble, so leading zeros are preserved
+const unsigned int packedBits     = 54;
+const uint64_t     packedMask     = (uint64_t(1) << packedBits) - 1;
+const size_t       packedMaxLen   = 15;
+
+// Routing tag id is split to 2 parts placed above the packed values
+const unsigned int tagPartBits    = 64 - packedBits;
+const uint64_t     tagPartMask    = (uint64_t(1) << tagPartBits) - 1;
+const size_t       tagsMax        = size_t(1) << (tagPartBits * 2);
+
+// Average entries count per bucket (two cache lines of entries)
+const size_t       bucketLoad     = 8;
+
+// Batch lookups are pipelined by groups, so prefetched
+// lines of the group are still in L1 on probing
+const size_t       batchGroupSize = 16;
+
+// File loading parallelism limits
+const size_t       maxLoadWorkers = 16;
+const size_t       minChunkSize   = 4 * 1024 * 1024;
+
+// Decompressed block parsed by one worker (also max line length)
+const size_t       streamBlockSize = 16 * 1024 * 1024;
+
+// Parsed lines between loading cancellation checks
+const size_t       cancelCheckLines = 64 * 1024;
+
+/**
+ * @brief Pack digits string to integer
+ *
+ * @return false if the value is not suitable for packing
+ */
+bool packNumber(string_view number, uint64_t & packed)
+{
+  if (number.size() > packedMaxLen)
+  {
+    return false;
+  }
+
+  uint64_t value = 0;
+  for (char c : number)
+  {
+    if ((c < '0') || (c > '9'))
+    {
+      return false;
+    }
+    value = value * 10 + (c - '0');
+  }
+
+  packed = (value << 4) | number.size();
+  return true;
+}
+
+void unpackNumber(uint64_t packed, string & number)
+{
+  size_t len = packed & 0x0F;
+  uint64_t value = (packed & packedMask) >> 4;
+
+  number.assign(len, '0');
+  while (len && value)
+  {
+    number[--len] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  }
+}
+
+/**
+ * @brief Finalizer of MurmurHash3 to spread packed numbers over buckets
+ */
+inline uint64_t mixHash(uint64_t k)
+{
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+  return k;
+}
+
+} // namespace
+
+/**************************************************************
+ * CSV client implementation
+***************************************************************/
+/**
+ * @brief Find the entry by the packed number
+ *
+ * @return nullptr if the number is not found
+ */
+const CCsvClient::SEntry_t * CCsvClient::STable_t::find(uint64_t key) const
+{
+  if (!entriesCnt)
+  {
+    return nullptr;
+  }
+
+  const uint64_t bucket = mixHash(key) >> (64 - bucketBits);
+  const SEntry_t * it  = entries + buckets[bucket];
+  const SEntry_t * end = entries + buckets[bucket + 1];
+
+  for (; it != end; ++it)
+  {
+    if ((it->key & packedMask) == key)
+    {
+      return it;
+    }
+  }
+
+  return nullptr;
+}
+
+/**
+ * @brief Check the table mapped from the snapshot
+ *
+ * @note Bucket offsets must be ascending within entries and entries
+ *       tags must refer to the tags table, so lookups stay in bounds
+ *
+ * @param[in] tagsCnt  The tags table size
+ *
+ * @return true if the table is consistent
+ */
+bool CCsvClient::STable_t::isValid(size_t tagsCnt) const
+{
+  const size_t bucketsCnt = size_t(1) << bucketBits;
+
+  if ((0 != buckets[0]) || (entriesCnt != buckets[bucketsCnt]))
+  {
+    return false;
+  }
+
+  for (size_t b = 0; b < bucketsCnt; ++b)
+  {
+    if (buckets[b] > buckets[b + 1])
+    {
+      return false;
+    }
+  }
+
+  for (size_t i = 0; i < entriesCnt; ++i)
+  {
+    if (entries[i].getTag() >= tagsCnt)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+CCsvClient::tag_id_t CCsvClient::SEntry_t::getTag() const
+{
+  return static_cast<tag_id_t>(((key >> packedBits) << tagPartBits) |
+                               (value >> packedBits));
+}
+
+void CCsvClient::SEntry_t::setTag(tag_id_t tag)
+{
+  key   = (key & packedMask)   | (uint64_t(tag >> tagPartBits) << packedBits);
+  value = (value & packedMask) | (uint64_t(tag & tagPartMask) << packedBits);
+}
+
+namespace
+{
+
+/**
+ * @brief Binary snapshot file header
+ *
+ * @note Sections follow the header aligned to the cache line:
+ *       - entries: SEntry_t[entriesCnt] grouped by bucket;
+ *       - buckets: uint32_t[(1 << bucketBits) + 1] entries offsets;
+ *       - prefix entries and buckets of the same layout (version 2);
+ *       - tags: uint32_t[tagsCnt + 1] data offsets followed by data;
+ *       - raw rows: records of uint32_t tag, uint32_t number length,
+ *         uint32_t routing number length followed by both values.
+ *       Values are in the byte order of the host which saved the file
+ */
+struct SSnapshotHeader_t
+{
+  char     magic[8];
+  uint32_t byteOrder;
+  uint32_t version;
+  uint32_t headerSize;
+  uint32_t bucketBits;
+  uint64_t entriesCnt;
+  uint64_t entriesOffset;
+  uint64_t bucketsOffset;
+  uint64_t tagsCnt;
+  uint64_t tagsOffset;
+  uint64_t rawRowsCnt;
+  uint64_t rawRowsOffset;
+  uint64_t fileSize;
+  // version 2
+  uint32_t prefixBucketBits;
+  uint32_t prefixLengths;
+  uint64_t prefixEntriesCnt;
+  uint64_t prefixEntriesOffset;
+  uint64_t prefixBucketsOffset;
+};
+
+const char     snapshotMagic[8]  = { 'Y', 'L', 'N', 'P', 'I', 'D', 'X', '\0' };
+const uint32_t snapshotByteOrder = 0x01020304;
+const uint32_t snapshotVersion   = 2;
+const size_t   snapshotV1HeaderSize = offsetof(SSnapshotHeader_t, prefixBucketBits);
+const size_t   snapshotAlignment = 64;
+
+inline size_t alignOffset(size_t offset)
+{
+  return (offset + snapshotAlignment - 1) & ~(snapshotAlignment - 1);
+}
+
+} // namespace
+
+/**
+ * @brief Map the whole file for reading
+ */
+CCsvClient::SMapping_t::SMapping_t(const char * filePath)
+{
+  int fd = open(filePath, O_RDONLY);
+  if (fd < 0)
+  {
+    throw CCsvClient::error("could not open file: %s", filePath);
+  }
+
+  struct stat st;
+  if (0 != fstat(fd, &st))
+  {
+    int e = errno;
+    close(fd);
+    throw CCsvClient::error("could not stat file: %s (%s)", filePath, strerror(e));
+  }
+
+  size = st.st_size;
+  if (size)
+  {
+    void * addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (MAP_FAILED == addr)
+    {
+      int e = errno;
+      close(fd);
+      throw CCsvClient::error("could not map file: %s (%s)", filePath, strerror(e));
+    }
+    data = static_cast<const char *>(addr);
+  }
+  close(fd);
+}
+
+CCsvClient::SMapping_t::~SMapping_t()
+{
+  if (data)
+  {
+    munmap(const_cast<char *>(data), size);
+  }
+}
+
+/**
+ * @brief Check the file header for the snapshot magic
+ */
+bool CCsvClient::isSnapshot(const SMapping_t & file)
+{
+  return (file.size >= snapshotV1HeaderSize) &&
+         (0 == memcmp(file.data, snapshotMagic, sizeof(snapshotMagic)));
+}
+
+/**
+ * @brief Use the index from the snapshot mapping in place
+ *
+ * @note Only the tags table and rows with not packed values are copied
+ */
+void CCsvClient::attachSnapshot(std::unique_ptr<SMapping_t> file, const char * filePath)
+{
+  auto startTime = std::chrono::steady_clock::now();
+
+  // version 1 header has no prefix fields
+  SSnapshotHeader_t hdr;
+  memset(&hdr, 0, sizeof(hdr));
+  memcpy(&hdr, file->data, snapshotV1HeaderSize);
+
+  if (snapshotByteOrder != hdr.byteOrder)
+  {
+    throw CCsvClient::error("snapshot %s has foreign byte order", filePath);
+  }
+  if ((1 != hdr.version) && (snapshotVersion != hdr.version))
+  {
+    throw CCsvClient::error("unsupported snapshot %s version %u", filePath, hdr.version);
+  }
+
+  const size_t headerSize = (1 == hdr.version) ? snapshotV1HeaderSize : sizeof(hdr);
+  if ((hdr.headerSize != headerSize) || (file->size < headerSize))
+  {
+    throw CCsvClient::error("snapshot %s is corrupted", filePath);
+  }
+  memcpy(&hdr, file->data, headerSize);
+
+  const size_t bucketsCnt = size_t(1) << hdr.bucketBits;
+  const size_t prefixBucketsCnt = size_t(1) << hdr.prefixBucketBits;
+  if ((hdr.fileSize != file->size) ||
+      (0 == hdr.bucketBits) || (hdr.bucketBits > 32) ||
+      (hdr.entriesCnt >= UINT32_MAX) || (hdr.tagsCnt > tagsMax) ||
+      (hdr.entriesOffset % sizeof(uint64_t)) || (hdr.bucketsOffset % sizeof(uint32_t)) ||
+      (hdr.tagsOffset % sizeof(uint32_t)) ||
+      (hdr.entriesOffset + hdr.entriesCnt * sizeof(SEntry_t) > file->size) ||
+      (hdr.bucketsOffset + (bucketsCnt + 1) * sizeof(uint32_t) > file->size) ||
+      (hdr.tagsOffset + (hdr.tagsCnt + 1) * sizeof(uint32_t) > file->size) ||
+      (hdr.rawRowsOffset > file->size))
+  {
+    throw CCsvClient::error("snapshot %s is corrupted", filePath);
+  }
+
+  if (hdr.prefixEntriesCnt &&
+      ((0 == hdr.prefixBucketBits) || (hdr.prefixBucketBits > 32) ||
+       (hdr.prefixEntriesCnt >= UINT32_MAX) || (hdr.prefixLengths > UINT16_MAX) ||
+       (hdr.prefixEntriesOffset % sizeof(uint64_t)) ||
+       (hdr.prefixBucketsOffset % sizeof(uint32_t)) ||
+       (hdr.prefixEntriesOffset + hdr.prefixEntriesCnt * sizeof(SEntry_t) > file->size) ||
+       (hdr.prefixBucketsOffset + (prefixBucketsCnt + 1) * sizeof(uint32_t) > file->size)))
+  {
+    throw CCsvClient::error("snapshot %s is corrupted", filePath);
+  }
+
+  const char * base = file->data;
+  mNumbers.bucketBits = hdr.bucketBits;
+  mNumbers.entries    = reinterpret_cast<const SEntry_t *>(base + hdr.entriesOffset);
+  mNumbers.entriesCnt = hdr.entriesCnt;
+  mNumbers.buckets    = reinterpret_cast<const uint32_t *>(base + hdr.bucketsOffset);
+
+  if (hdr.prefixEntriesCnt)
+  {
+    mPrefixes.bucketBits = hdr.prefixBucketBits;
+    mPrefixes.entries    = reinterpret_cast<const SEntry_t *>(base + hdr.prefixEntriesOffset);
+    mPrefixes.entriesCnt = hdr.prefixEntriesCnt;
+    mPrefixes.buckets    = reinterpret_cast<const uint32_t *>(base + hdr.prefixBucketsOffset);
+    mPrefixLengths       = static_cast<uint16_t>(hdr.prefixLengths);
+  }
+
+  // Tags table
+  const uint32_t * tagOffsets = reinterpret_cast<const uint32_t *>(base + hdr.tagsOffset);
+  const char * tagsData = reinterpret_cast<const char *>(tagOffsets + hdr.tagsCnt + 1);
+  const size_t tagsDataSize = file->size - (tagsData - base);
+
+  mTags.reserve(hdr.tagsCnt);
+  for (size_t i = 0; i < hdr.tagsCnt; ++i)
+  {
+    if ((tagOffsets[i] > tagOffsets[i + 1]) || (tagOffsets[i + 1] > tagsDataSize))
+    {
+      throw CCsvClient::error("snapshot %s is corrupted", filePath);
+    }
+    mTags.emplace_back(tagsData + tagOffsets[i], tagOffsets[i + 1] - tagOffsets[i]);
+  }
+
+  if (!mNumbers.isValid(mTags.size()) ||
+      (mPrefixes.entriesCnt && !mPrefixes.isValid(mTags.size())))
+  {
+    throw CCsvClient::error("snapshot %s is corrupted", filePath);
+  }
+
+  // Rows with not packed values
+  const char * p   = base + hdr.rawRowsOffset;
+  const char * end = base + file->size;
+  for (size_t i = 0; i < hdr.rawRowsCnt; ++i)
+  {
+    uint32_t rec[3];
+    if (static_cast<size_t>(end - p) < sizeof(rec))
+    {
+      throw CCsvClient::error("snapshot %s is corrupted", filePath);
+    }
+    memcpy(rec, p, sizeof(rec));
+    p += sizeof(rec);
+
+    if ((rec[0] >= mTags.size()) || (static_cast<size_t>(end - p) < size_t(rec[1]) + rec[2]))
+    {
+      throw CCsvClient::error("snapshot %s is corrupted", filePath);
+    }
+    mRawRows.emplace(string(p, rec[1]), SRawRow_t{ string(p + rec[1], rec[2]), rec[0] });
+    p += rec[1] + rec[2];
+  }
+
+  // lookups are random, no need to read ahead
+  madvise(const_cast<char *>(file->data), file->size, MADV_RANDOM);
+  mSnapshot = std::move(file);
+
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+  info("attached snapshot '%s' with %zu rows (%zu bytes) in %.3f seconds",
+       filePath, size(), mSnapshot->size, elapsed.count());
+}
+
+/**
+ * @brief Save the index to the binary snapshot file
+ *
+ * @note The file is written under the temporary name and renamed,
+ *       so the running processes keep their mappings of the old one
+ */
+void CCsvClient::save(const char * filePath) const
+{
+  SSnapshotHeader_t hdr;
+  memset(&hdr, 0, sizeof(hdr));
+  memcpy(hdr.magic, snapshotMagic, sizeof(snapshotMagic));
+  hdr.byteOrder  = snapshotByteOrder;
+  hdr.version    = snapshotVersion;
+  hdr.headerSize = sizeof(hdr);
+  hdr.bucketBits = mNumbers.bucketBits;
+  hdr.entriesCnt = mNumbers.entriesCnt;
+  hdr.tagsCnt    = mTags.size();
+  hdr.rawRowsCnt = mRawRows.size();
+  hdr.prefixBucketBits = mPrefixes.bucketBits;
+  hdr.prefixLengths    = mPrefixLengths;
+  hdr.prefixEntriesCnt = mPrefixes.entriesCnt;
+
+  // Tags table
+  vector<uint32_t> tagOffsets(1, 0);
+  for (const auto & t : mTags)
+  {
+    tagOffsets.push_back(tagOffsets.back() + t.size());
+  }
+
+  const size_t bucketsCnt = size_t(1) << mNumbers.bucketBits;
+  hdr.entriesOffset = alignOffset(sizeof(hdr));
+  hdr.bucketsOffset = alignOffset(hdr.entriesOffset + mNumbers.entriesCnt * sizeof(SEntry_t));
+  hdr.prefixEntriesOffset = alignOffset(hdr.bucketsOffset + (bucketsCnt + 1) * sizeof(uint32_t));
+  hdr.prefixBucketsOffset = alignOffset(hdr.prefixEntriesOffset +
+                                        mPrefixes.entriesCnt * sizeof(SEntry_t));
+  hdr.tagsOffset    = alignOffset(hdr.prefixBucketsOffset +
+                                  mPrefixes.bucketsCount() * sizeof(uint32_t));
+  hdr.rawRowsOffset = hdr.tagsOffset + tagOffsets.size() * sizeof(uint32_t) + tagOffsets.back();
+
+  size_t rawRowsSize = 0;
+  for (const auto & r : mRawRows)
+  {
+    rawRowsSize += 3 * sizeof(uint32_t) + r.first.size() + r.second.routingNumber.size();
+  }
+  hdr.fileSize = hdr.rawRowsOffset + rawRowsSize;
+
+  // Writing
+  string tmpPath = string(filePath) + ".tmp";
+  FILE * f = fopen(tmpPath.c_str(), "wb");
+  if (!f)
+  {
+    throw CCsvClient::error("could not create file: %s (%s)", tmpPath.c_str(), strerror(errno));
+  }
+
+  size_t written = 0;
+  auto put = [f, &written] (const void * data, size_t size) {
+    if (size && (1 != fwrite(data, size, 1, f)))
+    {
+      return false;
+    }
+    written += size;
+    return true;
+  };
+  auto pad = [&put, &written] (size_t offset) {
+    static const char zeros[snapshotAlignment] = { };
+    return put(zeros, offset - written);
+  };
+
+  bool ok = put(&hdr, sizeof(hdr)) &&
+            pad(hdr.entriesOffset) &&
+            put(mNumbers.entries, mNumbers.entriesCnt * sizeof(SEntry_t)) &&
+            pad(hdr.bucketsOffset);
+
+  if (ok && mNumbers.buckets)
+  {
+    ok = put(mNumbers.buckets, (bucketsCnt + 1) * sizeof(uint32_t));
+  }
+  else if (ok)
+  {
+    // empty index
+    vector<uint32_t> buckets(bucketsCnt + 1, 0);
+    ok = put(buckets.data(), buckets.size() * sizeof(uint32_t));
+  }
+
+  ok = ok && pad(hdr.prefixEntriesOffset) &&
+       put(mPrefixes.entries, mPrefixes.entriesCnt * sizeof(SEntry_t)) &&
+       pad(hdr.prefixBucketsOffset) &&
+       put(mPrefixes.buckets, mPrefixes.bucketsCount() * sizeof(uint32_t));
+
+  ok = ok && pad(hdr.tagsOffset) &&
+       put(tagOffsets.data(), tagOffsets.size() * sizeof(uint32_t));
+  for (const auto & t : mTags)
+  {
+    ok = ok && put(t.data(), t.size());
+  }
+  for (const auto & r : mRawRows)
+  {
+    uint32_t rec[3] = { r.second.tag,
+                        static_cast<uint32_t>(r.first.size()),
+                        static_cast<uint32_t>(r.second.routingNumber.size()) };
+    ok = ok && put(rec, sizeof(rec)) &&
+         put(r.first.data(), r.first.size()) &&
+         put(r.second.routingNumber.data(), r.second.routingNumber.size());
+  }
+
+  ok = (0 == fclose(f)) && ok;
+  if (!ok || (0 != rename(tmpPath.c_str(), filePath)))
+  {
+    int e = errno;
+    unlink(tmpPath.c_str());
+    throw CCsvClient::error("could not write file: %s (%s)", filePath, strerror(e));
+  }
+}
+
+/**
+ * @brief Part of the mapped file parsed by one worker
+ *
+ * @note Tag identifiers of parsed entries are local for the chunk
+ *       until the merge
+ */
+struct CCsvClient::SChunk_t
+{
+  struct SChunkRawRow_t
+  {
+    string    number;
+    SRawRow_t row;
+    size_t    rowsBefore;   // packed rows parsed before it, for the file order
+  };
+
+  enum EError_t
+  {
+    ECHUNK_ERROR_NONE = 0,
+    ECHUNK_ERROR_FIELD_FORMAT,
+    ECHUNK_ERROR_FIELDS_COUNT,
+    ECHUNK_ERROR_TAGS_COUNT,
+    ECHUNK_ERROR_CANCELLED
+  };
+
+  const char *  begin;
+  const char *  end;
+  const std::atomic<bool> * cancel = nullptr;
+  size_t        linesCnt = 0;
+  std::unique_ptr<char[]> buffer;   // decompressed block
+
+  vector<string> ownTags;           // tags copied from the released buffer
+
+  vector<SEntry_t> rows;
+  vector<SEntry_t> prefixRows;
+  vector<string_view> tags;
+  vector<SChunkRawRow_t> rawRows;
+
+  size_t        skippedPrefixesCnt = 0;   // prefixes of unsupported format
+  size_t        skippedPrefixLine  = 0;   // line number of the first one
+
+  EError_t      error = ECHUNK_ERROR_NONE;
+  size_t        errorLine = 0;    // line number within the chunk
+  size_t        errorField = 0;
+
+  void parse(const SLayout_t & layout, const char delimiter);
+  void release();
+};
+
+/**
+ * @brief Parse chunk lines with in-place fields scanning
+ *
+ * @note Follows std::getline() based parsing semantic: the line without
+ *       enough delimited fields is malformed, extra fields are ignored
+ */
+void CCsvClient::SChunk_t::parse(const SLayout_t & layout, const char delimiter)
+{
+  unordered_map<string_view, tag_id_t> tagIds;
+  vector<string_view> field(layout.fieldsNumber);
+  const char * p = begin;
+
+  while (p < end)
+  {
+    const char * eol = static_cast<const char *>(memchr(p, '\n', end - p));
+    if (!eol)
+    {
+      eol = end;
+    }
+    ++linesCnt;
+
+    if (cancel && (0 == linesCnt % cancelCheckLines) &&
+        cancel->load(std::memory_order_relaxed))
+    {
+      error     = ECHUNK_ERROR_CANCELLED;
+      errorLine = linesCnt;
+      return;
+    }
+
+    if (p == eol)
+    {
+      // Skip empty lines
+      p = eol + 1;
+      continue;
+    }
+
+    // Scan row fields
+    size_t validityCnt = 0;
+    for (size_t idx = 0; idx < layout.fieldsNumber; ++idx)
+    {
+      if (p >= eol)
+      {
+        error      = ECHUNK_ERROR_FIELD_FORMAT;
+        errorLine  = linesCnt;
+        errorField = idx + 1;
+        return;
+      }
+
+      const char * delim = static_cast<const char *>(memchr(p, delimiter, eol - p));
+      if (!delim)
+      {
+        delim = eol;
+      }
+
+      field[idx] = string_view(p, delim - p);
+      p = (delim < eol) ? delim + 1 : eol;
+
+      if (!field[idx].empty())
+      {
+        ++validityCnt;
+      }
+    }
+    p = eol + 1;
+
+    // Validate parsed results
+    size_t requiredFieldsCnt = layout.fieldsNumber - 1;
+    if (validityCnt < requiredFieldsCnt)
+    {
+      error     = ECHUNK_ERROR_FIELDS_COUNT;
+      errorLine = linesCnt;
+      return;
+    }
+
+    // Intern routing tag
+    string_view tag = field[layout.routingTagField];
+    auto tagIt = tagIds.find(tag);
+    if (tagIds.end() == tagIt)
+    {
+      if (tags.size() >= tagsMax)
+      {
+        error     = ECHUNK_ERROR_TAGS_COUNT;
+        errorLine = linesCnt;
+        return;
+      }
+      tagIt = tagIds.emplace(tag, static_cast<tag_id_t>(tags.size())).first;
+      tags.push_back(tag);
+    }
+
+    string_view number        = field[layout.numberField];
+    string_view routingNumber = field[layout.routingNumberField];
+
+    SEntry_t entry;
+    if (layout.prefixMatch && !number.empty() && ('*' == number.back()))
+    {
+      number.remove_suffix(1);
+      if (!packNumber(number, entry.key) || !packNumber(routingNumber, entry.value))
+      {
+        if (!skippedPrefixesCnt++)
+        {
+          skippedPrefixLine = linesCnt;
+        }
+        continue;
+      }
+      entry.setTag(tagIt->second);
+      prefixRows.push_back(entry);
+    }
+    else if (packNumber(number, entry.key) && packNumber(routingNumber, entry.value))
+    {
+      entry.setTag(tagIt->second);
+      rows.push_back(entry);
+    }
+    else
+    {
+      rawRows.push_back({ string(number),
+                          SRawRow_t{ string(routingNumber), tagIt->second },
+                          rows.size() });
+    }
+  }
+}
+
+/**
+ * @brief Release the decompressed block after parsing
+ *
+ * @note Only tags refer to the block data, they are copied
+ */
+void CCsvClient::SChunk_t::release()
+{
+  ownTags.reserve(tags.size());
+  for (auto & t : tags)
+  {
+    ownTags.emplace_back(t);
+    t = ownTags.back();
+  }
+
+  buffer.reset();
+  begin = end = nullptr;
+}
+
+/**
+ * @brief Compressed file decoder
+ */
+struct CCsvClient::SDecoder_t
+{
+  virtual ~SDecoder_t() = default;
+
+  // @return decoded bytes count, 0 at the end of the stream
+  virtual size_t read(char * buf, size_t size) = 0;
+
+  static std::unique_ptr<SDecoder_t> create(const SMapping_t & file,
+                                            const char * filePath);
+};
+
+/**
+ * @brief Gzip (zlib inflate) decoder, concatenated members are supported
+ */
+struct CCsvClient::SGzipDecoder_t : public CCsvClient::SDecoder_t
+{
+  z_stream       stream;
+  const char *   input;
+  size_t         inputLeft;     // not passed to the stream yet
+  bool           isEnd = false;
+
+  SGzipDecoder_t(const char * data, size_t size)
+    : input(data), inputLeft(size)
+  {
+    memset(&stream, 0, sizeof(stream));
+    // max window with gzip header detection
+    if (Z_OK != inflateInit2(&stream, 15 + 32))
+    {
+      throw CCsvClient::error("could not initialize gzip decoder");
+    }
+  }
+
+  ~SGzipDecoder_t() override
+  {
+    inflateEnd(&stream);
+  }
+
+  size_t read(char * buf, size_t size) override
+  {
+    // z_stream counters are 32-bit
+    const size_t maxStep = 1 << 30;
+
+    stream.next_out  = reinterpret_cast<Bytef *>(buf);
+    stream.avail_out = static_cast<uInt>(std::min(size, maxStep));
+
+    while (stream.avail_out && !isEnd)
+    {
+      if (!stream.avail_in && inputLeft)
+      {
+        size_t step = std::min(inputLeft, maxStep);
+        stream.next_in  = reinterpret_cast<Bytef *>(const_cast<char *>(input));
+        stream.avail_in = static_cast<uInt>(step);
+        input     += step;
+        inputLeft -= step;
+      }
+
+      int rc = inflate(&stream, Z_NO_FLUSH);
+      if (Z_STREAM_END == rc)
+      {
+        if (stream.avail_in || inputLeft)
+        {
+          inflateReset(&stream);
+          continue;
+        }
+        isEnd = true;
+      }
+      else if ((Z_BUF_ERROR == rc) && !stream.avail_in && !inputLeft)
+      {
+        throw CCsvClient::error("gzip stream is truncated");
+      }
+      else if (Z_OK != rc)
+      {
+        throw CCsvClient::error("gzip stream error: %s",
+                                stream.msg ? stream.msg : zError(rc));
+      }
+    }
+
+    return reinterpret_cast<char *>(stream.next_out) - buf;
+  }
+};
+
+#ifdef WITH_ZSTD
+/**
+ * @brief Zstandard decoder, concatenated frames are supported
+ */
+struct CCsvClient::SZstdDecoder_t : public CCsvClient::SDecoder_t
+{
+  ZSTD_DCtx *    ctx;
+  ZSTD_inBuffer  input;
+
+  SZstdDecoder_t(const char * data, size_t size)
+    : ctx(ZSTD_createDCtx()), input{ data, size, 0 }
+  {
+    if (!ctx)
+    {
+      throw CCsvClient::error("could not initialize zstd decoder");
+    }
+  }
+
+  ~SZstdDecoder_t() override
+  {
+    ZSTD_freeDCtx(ctx);
+  }
+
+  size_t read(char * buf, size_t size) override
+  {
+    ZSTD_outBuffer output = { buf, size, 0 };
+
+    while (output.pos < output.size)
+    {
+      const size_t prevPos = output.pos;
+      size_t rc = ZSTD_decompressStream(ctx, &output, &input);
+      if (ZSTD_isError(rc))
+      {
+        throw CCsvClient::error("zstd stream error: %s", ZSTD_getErrorName(rc));
+      }
+
+      // no progress with the whole input consumed
+      if ((input.pos == input.size) && (output.pos == prevPos))
+      {
+        if (rc)
+        {
+          throw CCsvClient::error("zstd stream is truncated");
+        }
+        break;
+      }
+    }
+
+    return output.pos;
+  }
+};
+#endif
+
+/**
+ * @brief Create decoder by the file header
+ *
+ * @return nullptr for not compressed file
+ */
+std::unique_ptr<CCsvClient::SDecoder_t> CCsvClient::SDecoder_t::create(
+                                                      const SMapping_t & file,
+                                                      const char * filePath)
+{
+  static const unsigned char gzipMagic[] = { 0x1f, 0x8b };
+  static const unsigned char zstdMagic[] = { 0x28, 0xb5, 0x2f, 0xfd };
+
+  if ((file.size >= sizeof(gzipMagic)) &&
+      (0 == memcmp(file.data, gzipMagic, sizeof(gzipMagic))))
+  {
+    return std::unique_ptr<SDecoder_t>(new SGzipDecoder_t(file.data, file.size));
+  }
+
+  if ((file.size >= sizeof(zstdMagic)) &&
+      (0 == memcmp(file.data, zstdMagic, sizeof(zstdMagic))))
+  {
+#ifdef WITH_ZSTD
+    return std::unique_ptr<SDecoder_t>(new SZstdDecoder_t(file.data, file.size));
+#else
+    throw CCsvClient::error("zstd compressed file %s is not supported by this build",
+                            filePath);
+#endif
+  }
+
+  return nullptr;
+}
+
+/**
+ * @brief Load CSV file rows to the index
+ *
+ * @note The file is mapped to memory and split to the chunks at line
+ *       boundaries. Chunks are parsed by worker threads and merged in
+ *       the file order, so the first occurrence of the number wins
+ */
+void CCsvClient::load(const SMapping_t & file,
+                      const char * fileName,
+                      const SLayout_t & layout,
+                      const char delimiter)
+{
+  if (0 == layout.fieldsNumber)
+  {
+    throw CCsvClient::error("invalid value for CSV values in the row");
+  }
+
+  auto startTime = std::chrono::steady_clock::now();
+
+  if (file.size)
+  {
+    madvise(const_cast<char *>(file.data), file.size, MADV_SEQUENTIAL);
+    madvise(const_cast<char *>(file.data), file.size, MADV_WILLNEED);
+  }
+
+  // Splitting to the chunks at line boundaries
+  const size_t fileSize = file.size;
+  const char * begin = file.data;
+  const char * end   = begin + fileSize;
+
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  size_t workersCnt = std::min<size_t>((cpus > 0) ? cpus : 1, maxLoadWorkers);
+  workersCnt = std::max<size_t>(1, std::min(workersCnt, fileSize / minChunkSize));
+
+  std::deque<SChunk_t> chunks(workersCnt);
+  const char * p = begin;
+  for (size_t i = 0; i < workersCnt; ++i)
+  {
+    const char * chunkEnd = end;
+    if (i + 1 < workersCnt)
+    {
+      chunkEnd = begin + fileSize / workersCnt * (i + 1);
+      if (chunkEnd < p)
+      {
+        chunkEnd = p;
+      }
+      const char * eol = static_cast<const char *>(memchr(chunkEnd, '\n', end - chunkEnd));
+      chunkEnd = eol ? eol + 1 : end;
+    }
+    chunks[i].begin  = p;
+    chunks[i].end    = chunkEnd;
+    chunks[i].cancel = mCancel;
+    p = chunkEnd;
+  }
+
+  // Parsing
+  if (1 == workersCnt)
+  {
+    chunks[0].parse(layout, delimiter);
+  }
+  else
+  {
+    vector<std::thread> workers;
+    for (auto & c : chunks)
+    {
+      workers.emplace_back(&SChunk_t::parse, &c, std::cref(layout), delimiter);
+    }
+    for (auto & w : workers)
+    {
+      w.join();
+    }
+  }
+
+  size_t linesCnt = build(chunks, layout);
+
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+  info("loaded %zu rows (%zu lines, %zu bytes) from '%s' by %zu threads "
+       "in %.3f seconds (%.1f MB/s)",
+       size(), linesCnt, fileSize, fileName, workersCnt, elapsed.count(),
+       elapsed.count() > 0 ? fileSize / elapsed.count() / (1024 * 1024) : 0.0);
+}
+
 /**
- * @brief Internal class helper to load CSV file to hash
+ * @brief Load compressed CSV file rows to the index
+ *
+ * @note The file is decompressed by blocks cut at line boundaries.
+ *       Blocks are parsed by worker threads while the next ones are
+ *       decompressed, and released once parsed. So the memory is
+ *       limited by the blocks in flight, not by the uncompressed size
  */
-static void loadCsvFile(CCsvClient::hash_t & hash,
-                        const char * fileName,
-                        const uint8_t primaryIdx,
-                        const uint8_t fieldsNumber,
-                        const char delimiter = ',')
+void CCsvClient::loadCompressed(const SMapping_t & file,
+                                SDecoder_t & decoder,
+                                const char * fileName,
+                                const SLayout_t & layout,
+                                const char delimiter)
 {
-  using std::getline;
+  if (0 == layout.fieldsNumber)
+  {
+    throw CCsvClient::error("invalid value for CSV values in the row");
+  }
+
+  auto startTime = std::chrono::steady_clock::now();
 
-  if (!fileName)
+  madvise(const_cast<char *>(file.data), file.size, MADV_SEQUENTIAL);
+  madvise(const_cast<char *>(file.data), file.size, MADV_WILLNEED);
+
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  const size_t workersCnt = std::min<size_t>((cpus > 0) ? cpus : 1, maxLoadWorkers);
+
+  std::deque<SChunk_t> chunks;
+  std::deque<std::thread> workers;
+  string tail;                  // incomplete line of the previous block
+  size_t decodedSize = 0;
+
+  auto joinAll = [&workers] () {
+    for (auto & w : workers)
+    {
+      w.join();
+    }
+    workers.clear();
+  };
+
+  try
   {
-    throw CCsvClient::error("not specified the path to CSV file");
+    for (bool isEnd = false; !isEnd;)
+    {
+      checkCancel();
+
+      std::unique_ptr<char[]> buffer(new char[tail.size() + streamBlockSize]);
+      memcpy(buffer.get(), tail.data(), tail.size());
+
+      size_t len = tail.size();
+      const size_t capacity = tail.size() + streamBlockSize;
+      while (len < capacity)
+      {
+        size_t cnt = decoder.read(buffer.get() + len, capacity - len);
+        if (!cnt)
+        {
+          isEnd = true;
+          break;
+        }
+        len += cnt;
+      }
+      decodedSize += len - tail.size();
+
+      // Cut at the last complete line
+      size_t blockLen = len;
+      if (!isEnd)
+      {
+        const char * eol = static_cast<const char *>(memrchr(buffer.get(), '\n', len));
+        if (!eol)
+        {
+          throw CCsvClient::error("too long line after %zu bytes", decodedSize);
+        }
+        blockLen = eol - buffer.get() + 1;
+      }
+      tail.assign(buffer.get() + blockLen, len - blockLen);
+
+      chunks.emplace_back();
+      SChunk_t & c = chunks.back();
+      c.begin  = buffer.get();
+      c.end    = buffer.get() + blockLen;
+      c.cancel = mCancel;
+      c.buffer = std::move(buffer);
+
+      // Limit blocks in flight
+      if (workers.size() >= workersCnt)
+      {
+        workers.front().join();
+        workers.pop_front();
+      }
+      workers.emplace_back([&c, &layout, delimiter] {
+        c.parse(layout, delimiter);
+        c.release();
+      });
+    }
   }
-  if (0 == fieldsNumber)
+  catch (...)
   {
-    throw CCsvClient::error("invalid value for CSV values in the row");
+    joinAll();
+    throw;
+  }
+  joinAll();
+
+  size_t linesCnt = build(chunks, layout);
+
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+  info("loaded %zu rows (%zu lines, %zu bytes decompressed from %zu) from '%s' "
+       "by %zu blocks in %.3f seconds (%.1f MB/s)",
+       size(), linesCnt, decodedSize, file.size, fileName, chunks.size(),
+       elapsed.count(),
+       elapsed.count() > 0 ? decodedSize / elapsed.count() / (1024 * 1024) : 0.0);
+}
+
+/**
+ * @brief Build the index from parsed chunks
+ *
+ * @return lines count
+ */
+size_t CCsvClient::build(std::deque<SChunk_t> & chunks, const SLayout_t & layout)
+{
+  // Errors are reported for the first malformed line of the file
+  size_t linesCnt = 0;
+  size_t skippedPrefixesCnt = 0;
+  size_t skippedPrefixLine = 0;
+  for (const auto & c : chunks)
+  {
+    switch (c.error)
+    {
+      case SChunk_t::ECHUNK_ERROR_NONE:
+        break;
+      case SChunk_t::ECHUNK_ERROR_FIELD_FORMAT:
+        throw CCsvClient::error("unexpected format field %zu at line %zu",
+                                 c.errorField, linesCnt + c.errorLine);
+      case SChunk_t::ECHUNK_ERROR_FIELDS_COUNT:
+        throw CCsvClient::error("required at least %zu valid fields in the line %zu",
+                                 layout.fieldsNumber, linesCnt + c.errorLine);
+      case SChunk_t::ECHUNK_ERROR_TAGS_COUNT:
+        throw CCsvClient::error("too many distinct routing tags at line %zu",
+                                 linesCnt + c.errorLine);
+      case SChunk_t::ECHUNK_ERROR_CANCELLED:
+        throw CCsvClient::error("loading is cancelled");
+    }
+    if (c.skippedPrefixesCnt && !skippedPrefixesCnt)
+    {
+      skippedPrefixLine = linesCnt + c.skippedPrefixLine;
+    }
+    skippedPrefixesCnt += c.skippedPrefixesCnt;
+    linesCnt += c.linesCnt;
+  }
+
+  if (skippedPrefixesCnt)
+  {
+    warn("skipped %zu prefix rows of unsupported format (not packable prefix "
+         "or routing number), the first one at line %zu",
+         skippedPrefixesCnt, skippedPrefixLine);
+  }
+
+  vector<SEntry_t> rows;
+  vector<SEntry_t> prefixRows;
+  merge(chunks, rows, prefixRows);
+  checkCancel();
+
+  for (const auto & r : prefixRows)
+  {
+    mPrefixLengths |= uint16_t(1) << (r.key & 0x0F);
   }
 
-  // Opening CSV file stream
-  std::ifstream csvInStream(fileName);
-  if (!csvInStream.is_open())
+  buildIndex(rows, mEntries, mBuckets, mNumbers);
+  checkCancel();
+  if (!prefixRows.empty())
   {
-    throw CCsvClient::error("could not open file: %s", fileName);
+    buildIndex(prefixRows, mPrefixEntries, mPrefixBuckets, mPrefixes);
   }
 
-  // CSV file parsing
-  string line;
-  size_t lineCnt = 0;
+  return linesCnt;
+}
+
+/**
+ * @brief Merge parsed chunks in the file order
+ *
+ * @note Chunk local tag identifiers are replaced by global ones.
+ *       The number could be both in packed and raw rows when its
+ *       routing number is not packable, only its first row is kept
+ */
+void CCsvClient::merge(std::deque<SChunk_t> & chunks,
+                       vector<SEntry_t> & rows, vector<SEntry_t> & prefixRows)
+{
+  unordered_map<string_view, tag_id_t> tagIds;
+  size_t rowsCnt = 0;
+  size_t prefixRowsCnt = 0;
+
+  // Raw rows with packable numbers by packed number
+  struct SRawPosition_t
+  {
+    const string * number;
+    size_t         position;    // merged packed rows before it
+  };
+  unordered_map<uint64_t, SRawPosition_t> rawPacked;
+
+  for (const auto & c : chunks)
+  {
+    rowsCnt += c.rows.size();
+    prefixRowsCnt += c.prefixRows.size();
+  }
+  rows.reserve(rowsCnt);
+  prefixRows.reserve(prefixRowsCnt);
 
-  while (getline(csvInStream, line) && ++lineCnt)
+  for (auto & c : chunks)
   {
-    if (line.empty())
+    // Chunk tags remapping table
+    vector<tag_id_t> tagMap(c.tags.size());
+    for (size_t i = 0; i < c.tags.size(); ++i)
     {
-      // Skip empty lines
-      continue;
+      auto it = tagIds.find(c.tags[i]);
+      if (tagIds.end() == it)
+      {
+        if (mTags.size() >= tagsMax)
+        {
+          throw CCsvClient::error("too many distinct routing tags");
+        }
+        it = tagIds.emplace(c.tags[i], static_cast<tag_id_t>(mTags.size())).first;
+        mTags.emplace_back(c.tags[i]);
+      }
+      tagMap[i] = it->second;
     }
 
-    // Parsing row from the file
-    std::stringstream lineStream(line);
-    vector<string> csvField(fieldsNumber);
-    size_t validityCnt = 0;
-    for (size_t idx = 0; idx < fieldsNumber; ++idx)
+    // first occurrence of the number wins
+    for (auto & r : c.rawRows)
     {
-      if (!getline(lineStream, csvField[idx], delimiter))
+      r.row.tag = tagMap[r.row.tag];
+      auto res = mRawRows.emplace(std::move(r.number), std::move(r.row));
+
+      // packable number with not packable routing number
+      uint64_t key;
+      if (res.second && packNumber(res.first->first, key))
       {
-        throw CCsvClient::error("unexpected format field %zu at line %zu",
-                                 (idx + 1), lineCnt);
+        rawPacked.emplace(key, SRawPosition_t{ &res.first->first, rows.size() + r.rowsBefore });
       }
-      if (!csvField[idx].empty())
+    }
+    c.rawRows.clear();
+
+    for (auto entry : c.rows)
+    {
+      entry.setTag(tagMap[entry.getTag()]);
+      rows.push_back(entry);
+    }
+    vector<SEntry_t>().swap(c.rows);
+
+    for (auto entry : c.prefixRows)
+    {
+      entry.setTag(tagMap[entry.getTag()]);
+      prefixRows.push_back(entry);
+    }
+    vector<SEntry_t>().swap(c.prefixRows);
+  }
+
+  if (rawPacked.empty())
+  {
+    return;
+  }
+
+  // The number is both in packed and raw rows: keep the first one
+  size_t kept = 0;
+  for (size_t i = 0; i < rows.size(); ++i)
+  {
+    auto it = rawPacked.find(rows[i].key & packedMask);
+    if (rawPacked.end() != it)
+    {
+      if (it->second.position <= i)
       {
-        ++validityCnt;
+        continue;
       }
+      mRawRows.erase(*it->second.number);
+      rawPacked.erase(it);
     }
+    rows[kept++] = rows[i];
+  }
+  rows.resize(kept);
+}
 
-    // Validate parsed results
-    size_t requiredFieldsCnt = fieldsNumber - 1;
-    if (validityCnt < requiredFieldsCnt)
+/**
+ * @brief Group loaded rows by hash buckets
+ *
+ * @note Rows order is preserved within the bucket and only the first
+ *       occurrence of the number is kept
+ *
+ * @param[in,out] rows     The loaded rows, released on return
+ * @param[out]    entries  The table entries storage
+ * @param[out]    buckets  The table buckets storage
+ * @param[out]    table    The table pointing to the storage
+ */
+void CCsvClient::buildIndex(vector<SEntry_t> & rows, vector<SEntry_t> & entries,
+                            vector<uint32_t> & buckets, STable_t & table)
+{
+  if (rows.size() >= UINT32_MAX)
+  {
+    throw CCsvClient::error("too many rows for the index: %zu", rows.size());
+  }
+
+  unsigned int bucketBits = 1;
+  while ((size_t(1) << bucketBits) * bucketLoad < rows.size())
+  {
+    ++bucketBits;
+  }
+
+  const size_t bucketsCnt = size_t(1) << bucketBits;
+  auto bucketOf = [bucketBits] (uint64_t key) {
+    return mixHash(key & packedMask) >> (64 - bucketBits);
+  };
+
+  // Counting sort by bucket
+  vector<uint32_t> offsets(bucketsCnt + 1, 0);
+  for (const auto & r : rows)
+  {
+    ++offsets[bucketOf(r.key) + 1];
+  }
+  for (size_t b = 0; b < bucketsCnt; ++b)
+  {
+    offsets[b + 1] += offsets[b];
+  }
+
+  vector<SEntry_t> placed(rows.size());
+  {
+    vector<uint32_t> pos(offsets.begin(), offsets.end() - 1);
+    for (const auto & r : rows)
     {
-      throw CCsvClient::error("required at least %zu valid fields in the line %zu",
-                               fieldsNumber, lineCnt);
+      placed[pos[bucketOf(r.key)]++] = r;
     }
+  }
+  vector<SEntry_t>().swap(rows);
 
-    const auto it = hash.find(csvField[primaryIdx]);
-    if (hash.cend() == it)
-    {
+  // Drop duplicated numbers
+  entries.clear();
+  entries.reserve(placed.size());
+  buckets.assign(bucketsCnt + 1, 0);
 
-      hash.emplace(csvField[primaryIdx],
-                   CCsvClient::SRow(lineCnt, csvField));
+  for (size_t b = 0; b < bucketsCnt; ++b)
+  {
+    const size_t first = entries.size();
+    buckets[b] = static_cast<uint32_t>(first);
+
+    for (uint32_t i = offsets[b]; i < offsets[b + 1]; ++i)
+    {
+      const uint64_t key = placed[i].key & packedMask;
+      bool isDuplicate = false;
+      for (size_t j = first; j < entries.size(); ++j)
+      {
+        if ((entries[j].key & packedMask) == key)
+        {
+          isDuplicate = true;
+          break;
+        }
+      }
+      if (!isDuplicate)
+      {
+        entries.push_back(placed[i]);
+      }
     }
   }
+  buckets[bucketsCnt] = static_cast<uint32_t>(entries.size());
+  entries.shrink_to_fit();
+
+  table.entries    = entries.data();
+  table.entriesCnt = entries.size();
+  table.buckets    = buckets.data();
+  table.bucketBits = bucketBits;
+}
+
+/**
+ * @brief Stop loading if it is cancelled
+ */
+void CCsvClient::checkCancel() const
+{
+  if (mCancel && mCancel->load(std::memory_order_relaxed))
+  {
+    throw CCsvClient::error("loading is cancelled");
+  }
 }
 
 /**
  * @brief Class constructor
  *
- * @param[in] filePath      The CSV file path for parsing and loading
- * @param[in] primaryField  The primary field used as key in the hash
- * @param[in] fieldsNumber  The CSV raw size
+ * @param[in] filePath  The CSV file path for parsing and loading
+ * @param[in] layout    The CSV row fields layout
+ * @param[in] cancel    The optional loading cancellation flag
+ */
+CCsvClient::CCsvClient(const char * filePath, const SLayout_t & layout,
+                       const std::atomic<bool> * cancel)
+  : mCancel(cancel)
+{
+  if (!filePath)
+  {
+    throw CCsvClient::error("not specified the path to CSV file");
+  }
+
+  std::unique_ptr<SMapping_t> file(new SMapping_t(filePath));
+
+  if (isSnapshot(*file))
+  {
+    attachSnapshot(std::move(file), filePath);
+    if (!layout.prefixMatch && mPrefixes.entriesCnt)
+    {
+      warn("snapshot '%s' prefixes are ignored without the prefix match",
+           filePath);
+      mPrefixes = STable_t();
+      mPrefixLengths = 0;
+    }
+    mCancel = nullptr;
+    return;
+  }
+
+  std::unique_ptr<SDecoder_t> decoder = SDecoder_t::create(*file, filePath);
+  if (decoder)
+  {
+    loadCompressed(*file, *decoder, filePath, layout);
+  }
+  else
+  {
+    load(*file, filePath, layout);
+  }
+
+  // the flag owner could be gone after the loading
+  mCancel = nullptr;
+}
+
+/**
+ * @brief Executing number searching in the memory index
+ *
+ * @param[in]  number         The number for processing request
+ * @param[out] routingNumber  The found routing number
+ * @param[out] routingTag     The found routing tag
+ *
+ * @return true if the number is found
  */
-CCsvClient::CCsvClient(const char * filePath,
-                       const uint8_t primaryField,
-                       const uint8_t fieldsNumber)
+bool CCsvClient::perform(const string & number,
+                         string & routingNumber,
+                         string & routingTag) const
 {
-  loadCsvFile(mHash, filePath, primaryField, fieldsNumber);
+  uint64_t key;
+
+  if (!packNumber(number, key))
+  {
+    return findRaw(number, routingNumber, routingTag);
+  }
+
+  const SEntry_t * entry = mNumbers.find(key);
+  if (!entry)
+  {
+    // the number with not packable routing number
+    if (!mRawRows.empty() && findRaw(number, routingNumber, routingTag))
+    {
+      return true;
+    }
+
+    entry = findPrefix(key);
+    if (!entry)
+    {
+      return false;
+    }
+  }
+
+  unpackNumber(entry->value, routingNumber);
+  routingTag = mTags[entry->getTag()];
+  return true;
 }
 
 /**
- * @brief Executing number searching in the memory hash table
+ * @brief Executing the longest prefix searching in the memory index
+ *
+ * @note The number own row is not looked up, e.g. when it is deleted
+ *       by the delta and only its prefix is applicable
  *
- * @param[in] number  The number for processing request
+ * @param[in]  number         The number for processing request
+ * @param[out] routingNumber  The found routing number
+ * @param[out] routingTag     The found routing tag
  *
- * @return CSV raw data as array with values
+ * @return true if the prefix is found
  */
-const CCsvClient::row_t * CCsvClient::perform(const char * number)
+bool CCsvClient::performPrefix(const string & number,
+                               string & routingNumber,
+                               string & routingTag) const
 {
-  if (!number)
+  uint64_t key;
+
+  if (!packNumber(number, key))
   {
-    throw error("not specified number for searching");
+    return false;
   }
 
-  const auto iter = mHash.find(number);
-  if (mHash.cend() == iter)
+  const SEntry_t * entry = findPrefix(key);
+  if (!entry)
   {
-    return nullptr;
+    return false;
+  }
+
+  unpackNumber(entry->value, routingNumber);
+  routingTag = mTags[entry->getTag()];
+  return true;
+}
+
+/**
+ * @brief Executing numbers searching in the memory index by batch
+ *
+ * @note Lookups are processed by groups in three passes: bucket
+ *       directory slots are prefetched for all keys of the group,
+ *       then the first entries of the buckets, then buckets are
+ *       probed. So memory misses of the group keys overlap instead
+ *       of being serialized as for perform() calls one by one
+ *
+ * @param[in,out] lookups  The lookups array
+ * @param[in]     count    The lookups count
+ */
+void CCsvClient::performBatch(SLookup_t * lookups, size_t count) const
+{
+  uint64_t keys[batchGroupSize];
+  uint64_t buckets[batchGroupSize];
+  bool     isPacked[batchGroupSize];
+
+  const unsigned int shift = 64 - mNumbers.bucketBits;
+
+  for (size_t first = 0; first < count; first += batchGroupSize)
+  {
+    SLookup_t * group = lookups + first;
+    const size_t groupCnt = std::min(batchGroupSize, count - first);
+
+    // Hashing and bucket directory prefetch
+    for (size_t i = 0; i < groupCnt; ++i)
+    {
+      isPacked[i] = packNumber(*group[i].number, keys[i]);
+      if (isPacked[i] && mNumbers.entriesCnt)
+      {
+        buckets[i] = mixHash(keys[i]) >> shift;
+        __builtin_prefetch(mNumbers.buckets + buckets[i]);
+      }
+    }
+
+    // Bucket entries prefetch
+    if (mNumbers.entriesCnt)
+    {
+      for (size_t i = 0; i < groupCnt; ++i)
+      {
+        if (isPacked[i])
+        {
+          const SEntry_t * it = mNumbers.entries + mNumbers.buckets[buckets[i]];
+          __builtin_prefetch(it);
+          __builtin_prefetch(it + 4);
+        }
+      }
+    }
+
+    // Probing
+    for (size_t i = 0; i < groupCnt; ++i)
+    {
+      SLookup_t & l = group[i];
+
+      if (!isPacked[i])
+      {
+        l.isFound = findRaw(*l.number, *l.routingNumber, *l.routingTag);
+        continue;
+      }
+
+      const SEntry_t * entry = nullptr;
+      if (mNumbers.entriesCnt)
+      {
+        const SEntry_t * it  = mNumbers.entries + mNumbers.buckets[buckets[i]];
+        const SEntry_t * end = mNumbers.entries + mNumbers.buckets[buckets[i] + 1];
+        for (; it != end; ++it)
+        {
+          if ((it->key & packedMask) == keys[i])
+          {
+            entry = it;
+            break;
+          }
+        }
+      }
+
+      if (!entry)
+      {
+        if (!mRawRows.empty() && findRaw(*l.number, *l.routingNumber, *l.routingTag))
+        {
+          l.isFound = true;
+          continue;
+        }
+
+        entry = findPrefix(keys[i]);
+      }
+
+      l.isFound = (nullptr != entry);
+      if (entry)
+      {
+        unpackNumber(entry->value, *l.routingNumber);
+        *l.routingTag = mTags[entry->getTag()];
+      }
+    }
+  }
+}
+
+/**
+ * @brief Find the row with the number not suitable for packing
+ */
+bool CCsvClient::findRaw(const string & number,
+                         string & routingNumber,
+                         string & routingTag) const
+{
+  const auto iter = mRawRows.find(number);
+  if (mRawRows.cend() == iter)
+  {
+    return false;
   }
 
-  return &iter->second;
+  routingNumber = iter->second.routingNumber;
+  routingTag    = mTags[iter->second.tag];
+  return true;
 }
 
 /**
- * @brief Overloaded method for number searching in the memory hash table
+ * @brief Find the longest prefix of the packed number
  *
- * @see CHttpClient::perform
+ * @note Only lengths present in the table are probed, from the
+ *       longest to the shortest one
+ */
+const CCsvClient::SEntry_t * CCsvClient::findPrefix(uint64_t key) const
+{
+  if (!mPrefixLengths)
+  {
+    return nullptr;
+  }
+
+  size_t len = key & 0x0F;
+  uint64_t value = key >> 4;
+
+  for (;;)
+  {
+    if (mPrefixLengths & (uint16_t(1) << len))
+    {
+      const SEntry_t * entry = mPrefixes.find((value << 4) | len);
+      if (entry)
+      {
+        return entry;
+      }
+    }
+
+    if (!len)
+    {
+      return nullptr;
+    }
+
+    --len;
+    value /= 10;
+  }
+}
+
+/**
+ * @brief Approximate memory footprint of the index in bytes
  */
-const CCsvClient::row_t * CCsvClient::perform(const string & number)
+size_t CCsvClient::memoryUsage() const
 {
-  return perform(number.c_str());
+  // index arrays are counted for the snapshot mapping as well
+  size_t rv = (mNumbers.entriesCnt + mPrefixes.entriesCnt) * sizeof(SEntry_t) +
+              (mNumbers.bucketsCount() + mPrefixes.bucketsCount()) * sizeof(uint32_t) +
+              mTags.capacity() * sizeof(string);
+
+  for (const auto & t : mTags)
+  {
+    rv += t.capacity();
+  }
+
+  // hash node with key, value and next pointer plus bucket pointer
+  rv += mRawRows.bucket_count() * sizeof(void *);
+  for (const auto & r : mRawRows)
+  {
+    rv += sizeof(void *) + sizeof(r) + r.first.capacity() +
+          r.second.routingNumber.capacity();
+  }
+
+  return rv;
 }
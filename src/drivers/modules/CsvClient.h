@@ -13,10 +13,42 @@ using std::vector;
 #include <unordered_map>
 using std::unordered_map;
 
+#include <cstdint>
+#include <memory>
+#include <deque>
+#include <atomic>
+
 #include "libs/fmterror.h"
 
 /**
  * @brief CSV client class
+ *
+ * @note Rows are kept in the compact index: numbers and routing numbers
+ *       are packed to 64-bit integers, routing tags are interned.
+ *       Entries are grouped by hash bucket in one flat array, so the
+ *       lookup touches the bucket directory and a couple of adjacent
+ *       cache lines. Rows with values which could not be packed
+ *       (non-numeric or longer than 15 digits) are kept as strings.
+ *
+ *       With the prefix match layout rows with the number ending by '*'
+ *       are prefixes (e.g. NPA-NXX blocks '1201555*'), otherwise '*'
+ *       is the part of the number. Prefixes are kept in the separate
+ *       table of the same layout and matched by the longest one when
+ *       the number is not found, so exact rows override prefixes. Only
+ *       digits prefixes of up to 15 digits with the packable routing
+ *       number are supported, '*' alone matches any number. Other
+ *       prefix rows are skipped with the warning.
+ *
+ *       Gzip and zstd (if built with libzstd) compressed files are
+ *       detected by the header and decompressed on the fly to the
+ *       blocks parsed in parallel, no uncompressed copy is stored.
+ *
+ *       The index could be saved to the binary snapshot file. Snapshot
+ *       is detected by the file header and used in place from the
+ *       read-only mapping, so its pages are shared between processes
+ *
+ *       Loading could be cancelled by the optional flag, it is checked
+ *       between parsed lines blocks and between the build stages
  */
 class CCsvClient
 {
@@ -30,36 +62,134 @@ class CCsvClient
           runtime_error(fmterror(fmt, args ...).get()) { }
     };
 
-    // Related type defines
-    struct SRow
+    // CSV row fields layout
+    struct SLayout_t
+    {
+      uint8_t numberField;          // primary field (used for searching)
+      uint8_t routingTagField;      // field value used for result routing tag
+      uint8_t routingNumberField;   // field value used for result routing number
+      uint8_t fieldsNumber;         // CSV row size
+      bool    prefixMatch;          // the number ending by '*' is the prefix
+    };
+
+    using tag_id_t = uint32_t;
+
+    // Batch lookup item
+    struct SLookup_t
     {
-        size_t id;
-        vector<string> field;
-
-        SRow(size_t i, vector<string> f)
-        {
-          id    = i;
-          field = std::move(f);
-        }
+      const string * number;
+      string *       routingNumber;
+      string *       routingTag;
+      bool           isFound;
     };
-    using row_t  = struct SRow;
-    using hash_t = unordered_map<string, row_t>;
 
   private:
-    hash_t mHash;   // in-memory hash table
+    // Index entry. Routing tag identifier is split between upper bits
+    // of both packed numbers to fit the entry into 16 bytes
+    struct SEntry_t
+    {
+      uint64_t key;     // packed number | tag id high bits
+      uint64_t value;   // packed routing number | tag id low bits
+
+      tag_id_t getTag() const;
+      void setTag(tag_id_t tag);
+    };
+
+    // Row with values not suitable for packing
+    struct SRawRow_t
+    {
+      string   routingNumber;
+      tag_id_t tag;
+    };
+
+    // Hash table of entries grouped by bucket. Arrays point to the
+    // owned vectors or to the snapshot mapping
+    struct STable_t
+    {
+      const SEntry_t * entries    = nullptr;
+      size_t           entriesCnt = 0;
+      const uint32_t * buckets    = nullptr;   // bucket first entry offset (with end sentinel)
+      unsigned int     bucketBits = 0;
+
+      const SEntry_t * find(uint64_t key) const;
+      bool isValid(size_t tagsCnt) const;
+      size_t bucketsCount() const { return buckets ? (size_t(1) << bucketBits) + 1 : 0; }
+    };
+
+    // Read-only file mapping
+    struct SMapping_t
+    {
+      const char * data = nullptr;
+      size_t       size = 0;
+
+      explicit SMapping_t(const char * filePath);
+      ~SMapping_t();
+    };
+
+    // Parallel loading helper
+    struct SChunk_t;
+
+    // Compressed file decoders
+    struct SDecoder_t;
+    struct SGzipDecoder_t;
+    struct SZstdDecoder_t;
+
+    STable_t          mNumbers;     // exact numbers
+    vector<SEntry_t>  mEntries;
+    vector<uint32_t>  mBuckets;
+
+    STable_t          mPrefixes;    // prefixes, the number is the prefix digits
+    vector<SEntry_t>  mPrefixEntries;
+    vector<uint32_t>  mPrefixBuckets;
+    uint16_t          mPrefixLengths = 0;   // bit per present prefix length
+
+    vector<string>    mTags;        // interned routing tags
+    unordered_map<string, SRawRow_t> mRawRows;
+
+    std::unique_ptr<SMapping_t> mSnapshot;
+
+    const std::atomic<bool> * mCancel = nullptr;   // loading cancellation flag
+
+    void load(const SMapping_t & file, const char * filePath,
+              const SLayout_t & layout, const char delimiter = ',');
+    void loadCompressed(const SMapping_t & file, SDecoder_t & decoder,
+                        const char * filePath, const SLayout_t & layout,
+                        const char delimiter = ',');
+    size_t build(std::deque<SChunk_t> & chunks, const SLayout_t & layout);
+    void merge(std::deque<SChunk_t> & chunks,
+               vector<SEntry_t> & rows, vector<SEntry_t> & prefixRows);
+    static void buildIndex(vector<SEntry_t> & rows, vector<SEntry_t> & entries,
+                           vector<uint32_t> & buckets, STable_t & table);
+    const SEntry_t * findPrefix(uint64_t key) const;
+    bool findRaw(const string & number,
+                 string & routingNumber, string & routingTag) const;
+
+    void checkCancel() const;
+
+    static bool isSnapshot(const SMapping_t & file);
+    void attachSnapshot(std::unique_ptr<SMapping_t> file, const char * filePath);
 
   public:
-    CCsvClient(const char *filePath, const uint8_t primaryField,
-               const uint8_t fieldsNumberm);
+    CCsvClient(const char * filePath, const SLayout_t & layout,
+               const std::atomic<bool> * cancel = nullptr);
     ~CCsvClient() = default;
 
     CCsvClient(const CCsvClient & cl)             = delete;
     CCsvClient & operator=(const CCsvClient & cl) = delete;
 
-    const row_t * perform(const char * number);
-    const row_t * perform(const string & number);
+    bool perform(const string & number,
+                 string & routingNumber, string & routingTag) const;
+    bool performPrefix(const string & number,
+                       string & routingNumber, string & routingTag) const;
+    void performBatch(SLookup_t * lookups, size_t count) const;
+
+    void save(const char * filePath) const;
+    bool isSnapshot() const { return static_cast<bool>(mSnapshot); }
 
-    size_t size() const { return mHash.size(); }
+    size_t size() const { return mNumbers.entriesCnt + mPrefixes.entriesCnt + mRawRows.size(); }
+    size_t prefixesCount() const { return mPrefixes.entriesCnt; }
+    size_t tagsCount() const { return mTags.size(); }
+    size_t memoryUsage() const;
 };
 
 #endif /* SERVER_SRC_DRIVERS_MODULES_CSVCLIENT_H_ */
@@ -0,0 +1,131 @@
+#include <fstream>
+#include <string_view>
+#include <vector>
+
+#include "CsvDelta.h"
+
+using std::string_view;
+using std::vector;
+
+/**
+ * @brief Class constructor
+ *
+ * @param[in] filePath  The delta file path
+ * @param[in] layout    The CSV row fields layout
+ */
+CCsvDelta::CCsvDelta(const char * filePath, const CCsvClient::SLayout_t & layout)
+{
+  if (!filePath)
+  {
+    throw error("not specified the path to CSV delta file");
+  }
+
+  std::ifstream csvInStream(filePath);
+  if (!csvInStream.is_open())
+  {
+    throw error("could not open file: %s", filePath);
+  }
+
+  const char delimiter = ',';
+  string line;
+  size_t lineCnt = 0;
+  vector<string_view> field(layout.fieldsNumber);
+
+  while (std::getline(csvInStream, line) && ++lineCnt)
+  {
+    if (line.empty())
+    {
+      // Skip empty lines
+      continue;
+    }
+
+    // Deletion
+    if ('-' == line[0])
+    {
+      string_view number(line.data() + 1, line.size() - 1);
+      number = number.substr(0, number.find(delimiter));
+      if (number.empty())
+      {
+        throw error("empty number to delete at line %zu", lineCnt);
+      }
+      if (layout.prefixMatch && ('*' == number.back()))
+      {
+        throw error("unsupported prefix in the delta at line %zu", lineCnt);
+      }
+
+      auto & row = mRows[string(number)];
+      row.isDeleted = true;
+      row.routingNumber.clear();
+      row.routingTag.clear();
+      ++mDeletes;
+      continue;
+    }
+
+    // Upsert, the same fields rules as for the full file
+    string_view rest(line);
+    size_t validityCnt = 0;
+    for (size_t idx = 0; idx < layout.fieldsNumber; ++idx)
+    {
+      if (rest.empty())
+      {
+        throw error("unexpected format field %zu at line %zu", (idx + 1), lineCnt);
+      }
+
+      size_t delim = rest.find(delimiter);
+      field[idx] = rest.substr(0, delim);
+      rest = (string_view::npos == delim) ? string_view() : rest.substr(delim + 1);
+
+      if (!field[idx].empty())
+      {
+        ++validityCnt;
+      }
+    }
+
+    if (validityCnt < size_t(layout.fieldsNumber - 1))
+    {
+      throw error("required at least %zu valid fields in the line %zu",
+                  size_t(layout.fieldsNumber), lineCnt);
+    }
+
+    const string_view number = field[layout.numberField];
+    if (layout.prefixMatch && !number.empty() && ('*' == number.back()))
+    {
+      throw error("unsupported prefix in the delta at line %zu", lineCnt);
+    }
+
+    auto & row = mRows[string(number)];
+    row.isDeleted = false;
+    row.routingNumber.assign(field[layout.routingNumberField].data(),
+                             field[layout.routingNumberField].size());
+    row.routingTag.assign(field[layout.routingTagField].data(),
+                          field[layout.routingTagField].size());
+    ++mUpserts;
+  }
+}
+
+/**
+ * @brief Executing number searching in the delta
+ *
+ * @param[in]  number         The number for processing request
+ * @param[out] routingNumber  The changed routing number
+ * @param[out] routingTag     The changed routing tag
+ */
+CCsvDelta::EResult_t CCsvDelta::perform(const string & number,
+                                        string & routingNumber,
+                                        string & routingTag) const
+{
+  const auto iter = mRows.find(number);
+  if (mRows.cend() == iter)
+  {
+    return EDELTA_NOT_FOUND;
+  }
+
+  if (iter->second.isDeleted)
+  {
+    return EDELTA_DELETED;
+  }
+
+  routingNumber = iter->second.routingNumber;
+  routingTag    = iter->second.routingTag;
+  return EDELTA_FOUND;
+}
@@ -0,0 +1,67 @@
+#ifndef SERVER_SRC_DRIVERS_MODULES_CSVDELTA_H_
+#define SERVER_SRC_DRIVERS_MODULES_CSVDELTA_H_
+
+#include <string>
+using std::string;
+
+#include <unordered_map>
+using std::unordered_map;
+
+#include "CsvClient.h"
+
+/**
+ * @brief Changes on top of the CSV client index
+ *
+ * @note Delta file has the same format as the full file, each line
+ *       replaces the row of the number. Line with the number prefixed
+ *       by '-' deletes the row:
+ *         0730112354,AT&T mobile,0901234455
+ *         -0730112355
+ *       Later lines win. Deleted number is still matched by the index
+ *       prefixes. Prefix rows (the number ending by '*' with the
+ *       prefix match layout) are not supported in the delta, change
+ *       them in the full file. Delta is
+ *       immutable once loaded, so the new delta is built aside and
+ *       swapped with the current one
+ */
+class CCsvDelta
+{
+  public:
+    using error = CCsvClient::error;
+
+    // Lookup result
+    enum EResult_t
+    {
+      EDELTA_NOT_FOUND = 0,   // number is not changed, use the base index
+      EDELTA_FOUND,
+      EDELTA_DELETED
+    };
+
+  private:
+    struct SRow_t
+    {
+      bool   isDeleted;
+      string routingNumber;
+      string routingTag;
+    };
+
+    unordered_map<string, SRow_t> mRows;
+    size_t mUpserts = 0;
+    size_t mDeletes = 0;
+
+  public:
+    CCsvDelta(const char * filePath, const CCsvClient::SLayout_t & layout);
+    ~CCsvDelta() = default;
+
+    CCsvDelta(const CCsvDelta & cl)             = delete;
+    CCsvDelta & operator=(const CCsvDelta & cl) = delete;
+
+    EResult_t perform(const string & number,
+                      string & routingNumber, string & routingTag) const;
+
+    size_t size() const     { return mRows.size(); }
+    size_t upserts() const  { return mUpserts; }
+    size_t deletes() const  { return mDeletes; }
+};
+
+#endif /* SERVER_SRC_DRIVERS_MODULES_CSVDELTA_H_ */
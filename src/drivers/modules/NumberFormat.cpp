@@ -0,0 +1,26 @@
+#include "NumberFormat.h"
+
+string national_number(string_view number, string_view country_code)
+{
+    string digits;
+    digits.reserve(number.size());
+    for(char c : number)
+        if(c >= '0' && c <= '9') digits += c;
+
+    if(digits.compare(0, 2, "00") == 0) {
+        //international call prefix
+        digits.erase(0, 2);
+    } else if(digits.compare(0, 1, "0") == 0) {
+        //national trunk prefix
+        digits.erase(0, 1);
+        return digits;
+    }
+
+    if(!country_code.empty() && digits.size() > country_code.size() &&
+       digits.compare(0, country_code.size(), country_code) == 0)
+    {
+        digits.erase(0, country_code.size());
+    }
+
+    return digits;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+using std::string;
+using std::string_view;
+
+/**
+ * @brief National significant number to compare numbers given in the
+ *        different formats: national with trunk '0' (08075597646),
+ *        international with or without '+' or '00' (2348075597646)
+ *
+ * @note Non-digit characters are ignored
+ *
+ * @param[in] number        The number in any format
+ * @param[in] country_code  The country calling code (e.g. "234")
+ */
+string national_number(string_view number, string_view country_code);
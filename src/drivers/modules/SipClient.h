@@ -23,7 +23,7 @@ class CSipClientDestructor;
 /**
  * @brief SIP client singletone class
  */
-class CSipClient: public thread
+class CSipClient: public ::thread
 {
   public:
     // Client exception class
@@ -0,0 +1,161 @@
+#include "UrlTemplate.h"
+
+/**
+ * @brief Parse URL template with '{key}' placeholders
+ */
+void UrlTemplate::parse(const string &url)
+{
+    //split url to the parts
+    auto s = url.data();
+    enum {
+        ST_NORMAL = 0,
+        ST_PLACEHOLDER
+    } state = ST_NORMAL;
+
+    size_t i, pos = 0;
+
+    uri_parts.clear();
+
+    for(i = 0; i < url.size(); i++)
+    {
+        char c = s[i];
+        switch(state) {
+        case ST_NORMAL:
+            switch(c) {
+            case '{':
+                //new placeholder
+                if(i > pos) {
+                    //save previous static part
+                    uri_parts.emplace_back(
+                        UriPart::URI_PART_STRING,
+                        url.substr(pos, i - pos));
+                }
+                pos = i+1;
+                state = ST_PLACEHOLDER;
+                break;
+            case '}':
+                throw std::runtime_error("unexpected '}' in the url template");
+            default:
+                break;
+            } //switch(c)
+            break;
+        case ST_PLACEHOLDER:
+            switch(c) {
+            case '}':
+                //placeholder closed
+                if(1 > (i - pos)) {
+                    throw std::runtime_error("empty placeholder in the url template");
+                }
+                uri_parts.emplace_back(
+                    UriPart::URI_PART_PLACEHOLDER,
+                    url.substr(pos, i - pos));
+                pos = i+1;
+                state = ST_NORMAL;
+                break;
+            case '{':
+                throw std::runtime_error("unexpected '{' in the url template");
+            default:
+                break;
+            } //switch(c)
+            break;
+        }
+    }
+
+    if(ST_PLACEHOLDER == state) {
+        throw std::runtime_error("unclosed placeholder in the url template");
+    }
+
+    if(i > pos) {
+        //save tail static part
+        uri_parts.emplace_back(
+            UriPart::URI_PART_STRING,
+            url.substr(pos, i - pos));
+    }
+
+    update_capacity();
+}
+
+/**
+ * @brief Append static part as is (no placeholders processing)
+ */
+void UrlTemplate::append_string(const string &data)
+{
+    if(data.empty())
+        return;
+
+    //merge with the previous static part
+    if(!uri_parts.empty() && uri_parts.back().type == UriPart::URI_PART_STRING)
+        uri_parts.back().data += data;
+    else
+        uri_parts.emplace_back(UriPart::URI_PART_STRING, data);
+
+    update_capacity();
+}
+
+void UrlTemplate::append_placeholder(const string &key)
+{
+    if(key.empty())
+        throw std::runtime_error("empty placeholder in the url template");
+
+    uri_parts.emplace_back(UriPart::URI_PART_PLACEHOLDER, key);
+    update_capacity();
+}
+
+/**
+ * @brief Set expected max length of the placeholder value
+ *
+ * @note Longer values are still rendered at the cost of buffer reallocation
+ */
+void UrlTemplate::set_max_value_size(size_t size)
+{
+    max_value_size = size;
+    update_capacity();
+}
+
+void UrlTemplate::update_capacity()
+{
+    capacity = 0;
+    for(const auto &p: uri_parts) {
+        if(p.type == UriPart::URI_PART_STRING)
+            capacity += p.data.size();
+        else
+            //worst case is percent-encoding of each value byte
+            capacity += max_value_size * 3;
+    }
+}
+
+string &UrlTemplate::buffer()
+{
+    static thread_local string buf;
+    return buf;
+}
+
+string &UrlTemplate::prepare() const
+{
+    string &out = buffer();
+    out.clear();
+    //no-op unless some template exceeds the buffer warmed up before
+    out.reserve(capacity);
+    return out;
+}
+
+/**
+ * @brief Append value with percent-encoding of all but unreserved characters (RFC 3986)
+ */
+void UrlTemplate::append_encoded(string &out, string_view value)
+{
+    static const char hex[] = "0123456789ABCDEF";
+
+    for(unsigned char c: value) {
+        if((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+           (c >= '0' && c <= '9') ||
+           c == '-' || c == '.' || c == '_' || c == '~')
+        {
+            out += static_cast<char>(c);
+            continue;
+        }
+        out += '%';
+        out += hex[c >> 4];
+        out += hex[c & 0x0F];
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <stdexcept>
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+/**
+ * @brief Precompiled request URL
+ *
+ * @note URL is split to the static parts and placeholders once at the
+ *       configuration time. Rendering appends parts to the per-thread
+ *       buffer reserved for the longest expected URL, so the request path
+ *       does not touch the heap once the buffer is warmed up
+ */
+class UrlTemplate
+{
+  public:
+    // expected max length of placeholder value before encoding
+    static const size_t DEFAULT_MAX_VALUE_SIZE = 64;
+
+  private:
+    struct UriPart {
+        enum uri_part_type {
+            URI_PART_STRING = 0,
+            URI_PART_PLACEHOLDER
+        } type;
+        //string or placeholder key
+        string data;
+        UriPart(uri_part_type type, const string &data)
+          : type(type),
+            data(data)
+        {}
+    };
+
+    vector<UriPart> uri_parts;
+    size_t max_value_size = DEFAULT_MAX_VALUE_SIZE;
+    size_t capacity = 0;
+
+    static string &buffer();
+    string &prepare() const;
+    void update_capacity();
+
+  public:
+    void parse(const string &url);
+    void append_string(const string &data);
+    void append_placeholder(const string &key);
+    void set_max_value_size(size_t size);
+
+    bool empty() const { return uri_parts.empty(); }
+    size_t get_capacity() const { return capacity; }
+
+    static void append_encoded(string &out, string_view value);
+
+    /**
+     * @brief Render URL with all placeholders replaced by the encoded value
+     *
+     * @return reference to the per-thread buffer valid until the next render
+     */
+    const string &render(string_view value) const
+    {
+        return render_with([value](const string &, string &out) {
+            append_encoded(out, value);
+        });
+    }
+
+    /**
+     * @brief Render URL with placeholder values appended by the callback
+     *
+     * @param[in] append_value  void(const string &key, string &out). Callback
+     *                          is responsible for the value encoding
+     *
+     * @return reference to the per-thread buffer valid until the next render
+     */
+    template <typename F>
+    const string &render_with(F &&append_value) const
+    {
+        string &out = prepare();
+        for(const auto &p: uri_parts) {
+            if(p.type == UriPart::URI_PART_STRING)
+                out.append(p.data);
+            else
+                append_value(p.data, out);
+        }
+        return out;
+    }
+};
@@ -85,4 +85,10 @@ jsonxx::item & jsonxx::operator[] (const char * value)
   return *(mItem.get());
 }
 
-
+/**
+ * @brief JSON basic class check for the optional item presence
+ */
+bool jsonxx::has(const char * value) const
+{
+  return value && cJSON_GetObjectItem(mData, value);
+}
@@ -58,6 +58,7 @@ class jsonxx
     ~jsonxx();
 
     item & operator[](const char * value);
+    bool has(const char * value) const;
 };
 
 /**
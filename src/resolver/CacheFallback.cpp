@@ -0,0 +1,302 @@
+#include "CacheFallback.h"
+#include "Resolver.h"
+#include "cfg.h"
+#include "log.h"
+
+#include <sys/epoll.h>
+#include <algorithm>
+
+#define RECONNECT_DELAY_MS 5000
+#define MAX_PENDING_PER_CONNECTION 1024
+
+CacheFallback::CacheFallback(Callback callback)
+  : on_finished(callback),
+    timer([this]() { on_timer(); })
+{
+    if (!cfg.db.cache_fallback_connections)
+        return;
+
+    query = cfg.db.cache_fallback_query;
+    connections.resize(cfg.db.cache_fallback_connections);
+    for (auto &c : connections)
+        connect(c);
+
+    arm_timer();
+}
+
+CacheFallback::~CacheFallback()
+{
+    for (auto &c : connections) {
+        if (c.fd >= 0)
+            unlink(c.fd);
+        if (c.conn)
+            PQfinish(c.conn);
+    }
+}
+
+void CacheFallback::connect(Connection &c)
+{
+    string conn_str = cfg.db.get_conn_string() +
+        " options = '-csearch_path=" + cfg.db.schema + ",public'";
+
+    c.conn = PQconnectStart(conn_str.c_str());
+    if (!c.conn || PQstatus(c.conn) == CONNECTION_BAD) {
+        err("cache fallback connection failed: %s",
+            c.conn ? PQerrorMessage(c.conn) : "out of memory");
+        disconnect(c);
+        return;
+    }
+
+    PQsetnonblocking(c.conn, 1);
+    c.state = CONNECTING;
+    // poll as for PGRES_POLLING_WRITING at start
+    watch(c, EPOLLOUT);
+}
+
+void CacheFallback::disconnect(Connection &c)
+{
+    if (c.fd >= 0)
+        unlink(c.fd);
+    if (c.conn)
+        PQfinish(c.conn);
+
+    c.conn = nullptr;
+    c.fd = -1;
+    c.state = DISCONNECTED;
+    c.retry_time = std::chrono::steady_clock::now() +
+                   std::chrono::milliseconds(RECONNECT_DELAY_MS);
+
+    if (c.current)
+        finish(std::move(c.current));
+}
+
+void CacheFallback::watch(Connection &c, uint32_t events)
+{
+    int fd = PQsocket(c.conn);
+
+    // libpq could reopen the socket while connecting
+    if (c.fd >= 0 && c.fd != fd) {
+        unlink(c.fd);
+        c.fd = -1;
+    }
+
+    if (fd < 0)
+        return;
+
+    if (c.fd < 0) {
+        c.fd = fd;
+        link(fd, events);
+    } else {
+        modify_link(fd, events);
+    }
+}
+
+int CacheFallback::handle_event(int fd, uint32_t events, bool &)
+{
+    auto it = std::find_if(connections.begin(), connections.end(),
+        [fd](const Connection &c) { return c.fd == fd; });
+    if (it == connections.end())
+        return -1;
+
+    Connection &c = *it;
+
+    if (c.state == CONNECTING) {
+        on_connecting(c);
+    } else {
+        if (events & EPOLLOUT) {
+            int ret = PQflush(c.conn);
+            if (ret < 0) {
+                err("cache fallback send failed: %s", PQerrorMessage(c.conn));
+                disconnect(c);
+                arm_timer();
+                return -1;
+            }
+            if (ret == 0)
+                watch(c, EPOLLIN);
+        }
+        if (events & (EPOLLIN | EPOLLERR | EPOLLHUP))
+            on_result(c);
+    }
+
+    arm_timer();
+    return 0;
+}
+
+void CacheFallback::on_connecting(Connection &c)
+{
+    switch (PQconnectPoll(c.conn)) {
+    case PGRES_POLLING_READING:
+        watch(c, EPOLLIN);
+        break;
+    case PGRES_POLLING_WRITING:
+        watch(c, EPOLLOUT);
+        break;
+    case PGRES_POLLING_OK:
+        info("cache fallback connected to database. backend pid: %d.",
+             PQbackendPID(c.conn));
+        c.state = IDLE;
+        watch(c, EPOLLIN);
+        send_pending();
+        break;
+    default:
+        dbg("cache fallback connection failed: %s", PQerrorMessage(c.conn));
+        disconnect(c);
+        break;
+    }
+}
+
+void CacheFallback::on_result(Connection &c)
+{
+    if (!PQconsumeInput(c.conn)) {
+        dbg("cache fallback connection error: %s", PQerrorMessage(c.conn));
+        disconnect(c);
+        return;
+    }
+
+    while (!PQisBusy(c.conn)) {
+        PGresult *r = PQgetResult(c.conn);
+        if (!r) {
+            // query is complete
+            if (c.state == BUSY) {
+                c.state = IDLE;
+                if (c.current)
+                    finish(std::move(c.current));
+                send_pending();
+            }
+            return;
+        }
+
+        if (PQresultStatus(r) != PGRES_TUPLES_OK) {
+            dbg("cache fallback query error: %s", PQresultErrorMessage(r));
+        } else if (c.current && PQntuples(r) > 0) {
+            ResolverRequest &request = *c.current->request;
+            request.result.localRoutingNumber = PQgetvalue(r, 0, 0);
+            request.result.localRoutingTag =
+                PQnfields(r) > 1 ? PQgetvalue(r, 0, 1) : "";
+            c.current->is_found = true;
+        }
+        PQclear(r);
+    }
+}
+
+bool CacheFallback::send(Connection &c, std::unique_ptr<Lookup> &l)
+{
+    string db_id = std::to_string(l->request->db_id);
+    const char *values[] = { db_id.c_str(), l->request->data.c_str() };
+
+    if (!PQsendQueryParams(c.conn, query.c_str(), 2, nullptr,
+                           values, nullptr, nullptr, 0))
+    {
+        dbg("cache fallback query failed: %s", PQerrorMessage(c.conn));
+        disconnect(c);
+        return false;
+    }
+
+    int ret = PQflush(c.conn);
+    if (ret < 0) {
+        dbg("cache fallback send failed: %s", PQerrorMessage(c.conn));
+        disconnect(c);
+        return false;
+    }
+
+    watch(c, ret ? EPOLLIN | EPOLLOUT : EPOLLIN);
+    c.state = BUSY;
+    c.current = std::move(l);
+
+    return true;
+}
+
+void CacheFallback::send_pending()
+{
+    for (auto &c : connections) {
+        if (pending.empty())
+            return;
+        if (c.state == IDLE && send(c, pending.front()))
+            pending.pop_front();
+    }
+}
+
+void CacheFallback::finish(std::unique_ptr<Lookup> l)
+{
+    if (on_finished)
+        on_finished(*l);
+}
+
+void CacheFallback::lookup(const ResolverRequest &request,
+                           const ECErrorId code,
+                           const std::string &description)
+{
+    std::unique_ptr<Lookup> l(new Lookup);
+    l->request.reset(new ResolverRequest(request));
+    l->code = code;
+    l->description = description;
+    l->start = std::chrono::steady_clock::now();
+    l->deadline = l->start +
+        std::chrono::milliseconds(cfg.db.cache_fallback_timeout);
+
+    // database is too slow or unavailable
+    if (pending.size() >= connections.size() * MAX_PENDING_PER_CONNECTION) {
+        finish(std::move(l));
+        return;
+    }
+
+    pending.emplace_back(std::move(l));
+    send_pending();
+    arm_timer();
+}
+
+void CacheFallback::on_timer()
+{
+    auto now = std::chrono::steady_clock::now();
+
+    // all lookups have the same timeout, so the first expires first
+    while (!pending.empty() && pending.front()->deadline <= now) {
+        std::unique_ptr<Lookup> l(std::move(pending.front()));
+        pending.pop_front();
+        l->is_timeout = true;
+        finish(std::move(l));
+    }
+
+    for (auto &c : connections) {
+        if (c.state == BUSY && c.current && c.current->deadline <= now) {
+            // result is discarded when it arrives
+            c.current->is_timeout = true;
+            finish(std::move(c.current));
+        } else if (c.state == DISCONNECTED && c.retry_time <= now) {
+            connect(c);
+        }
+    }
+
+    arm_timer();
+}
+
+void CacheFallback::arm_timer()
+{
+    bool armed = false;
+    std::chrono::steady_clock::time_point next;
+    auto update = [&armed, &next](std::chrono::steady_clock::time_point t) {
+        if (!armed || t < next)
+            next = t;
+        armed = true;
+    };
+
+    if (!pending.empty())
+        update(pending.front()->deadline);
+
+    for (const auto &c : connections) {
+        if (c.state == BUSY && c.current)
+            update(c.current->deadline);
+        else if (c.state == DISCONNECTED)
+            update(c.retry_time);
+    }
+
+    if (!armed) {
+        timer.stop();
+        return;
+    }
+
+    auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(
+        next - std::chrono::steady_clock::now());
+
+    timer.start(std::max<long>(timeout.count(), 0), false);
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "dispatcher/EventHandler.h"
+#include "dispatcher/Timer.h"
+#include "ResolverException.h"
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <chrono>
+#include <functional>
+
+#include <libpq-fe.h>
+
+struct ResolverRequest;
+
+/**
+ * @brief Stale results lookup in the database LNP cache table
+ *
+ * @note Used when the driver fails to resolve the tagged request.
+ *       Lookups are sent by the pool of asynchronous libpq connections
+ *       handled by the dispatcher loop, so the resolver never waits
+ *       for the database. Lookup not answered within the timeout is
+ *       finished as not found
+ */
+class CacheFallback : public EventHandler {
+public:
+    struct Lookup {
+        std::unique_ptr<ResolverRequest> request;
+        ECErrorId code;             // driver error to reply on miss
+        std::string description;
+        std::chrono::steady_clock::time_point start;
+        std::chrono::steady_clock::time_point deadline;
+        bool is_found = false;
+        bool is_timeout = false;
+    };
+
+    using Callback = std::function<void (Lookup &lookup)>;
+
+    explicit CacheFallback(Callback callback);
+    ~CacheFallback();
+
+    bool is_enabled() const { return !connections.empty(); }
+
+    void lookup(const ResolverRequest &request,
+                const ECErrorId code,
+                const std::string &description);
+
+    /* EventHandler overrides */
+    int handle_event(int fd, uint32_t events, bool &stop) override;
+
+private:
+    enum State {
+        DISCONNECTED,
+        CONNECTING,
+        IDLE,
+        BUSY
+    };
+
+    struct Connection {
+        PGconn *conn = nullptr;
+        int fd = -1;
+        State state = DISCONNECTED;
+        std::chrono::steady_clock::time_point retry_time;
+        std::unique_ptr<Lookup> current;  // null if timed out while sent
+    };
+
+    void connect(Connection &c);
+    void disconnect(Connection &c);
+    void watch(Connection &c, uint32_t events);
+    void on_connecting(Connection &c);
+    void on_result(Connection &c);
+    bool send(Connection &c, std::unique_ptr<Lookup> &l);
+    void send_pending();
+    void finish(std::unique_ptr<Lookup> l);
+
+    void on_timer();
+    void arm_timer();
+
+    std::string query;
+    std::vector<Connection> connections;
+    std::deque<std::unique_ptr<Lookup>> pending;
+    Callback on_finished;
+    Timer timer;
+};
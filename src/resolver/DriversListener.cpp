@@ -0,0 +1,316 @@
+#include "DriversListener.h"
+#include "cfg.h"
+#include "log.h"
+
+#include <sys/epoll.h>
+#include <cstdlib>
+
+#define RECONNECT_DELAY_MS 5000
+#define LOAD_DRIVERS_QUERY "SELECT * FROM load_lnp_databases()"
+
+DriversListener::DriversListener(Callback callback)
+  : conn(nullptr),
+    fd(-1),
+    state(DISCONNECTED),
+    connected_once(false),
+    pending_all(false),
+    loading_all(false),
+    loading_failed(false),
+    on_changed(callback),
+    timer([this]() { on_timer(); })
+{
+    if (cfg.db.drivers_config_from_file)
+        return;
+
+    channel = cfg.db.drivers_notify_channel;
+    if (channel.empty())
+        return;
+
+    connect();
+}
+
+DriversListener::~DriversListener()
+{
+    if (fd >= 0)
+        unlink(fd);
+    if (conn)
+        PQfinish(conn);
+}
+
+void DriversListener::connect()
+{
+    string conn_str = cfg.db.get_conn_string() +
+        " options = '-csearch_path=" + cfg.db.schema + ",public'";
+
+    conn = PQconnectStart(conn_str.c_str());
+    if (!conn || PQstatus(conn) == CONNECTION_BAD) {
+        err("drivers listener connection failed: %s",
+            conn ? PQerrorMessage(conn) : "out of memory");
+        disconnect();
+        return;
+    }
+
+    PQsetnonblocking(conn, 1);
+    state = CONNECTING;
+    // poll as for PGRES_POLLING_WRITING at start
+    watch(EPOLLOUT);
+}
+
+void DriversListener::disconnect()
+{
+    if (fd >= 0)
+        unlink(fd);
+    if (conn)
+        PQfinish(conn);
+
+    conn = nullptr;
+    fd = -1;
+    state = DISCONNECTED;
+
+    // changes being loaded are loaded again with the full reload
+    loading_ids.clear();
+    loading_all = false;
+    loading_failed = false;
+    configs.clear();
+
+    timer.start(RECONNECT_DELAY_MS, false);
+}
+
+void DriversListener::watch(uint32_t events)
+{
+    int new_fd = PQsocket(conn);
+
+    // libpq could reopen the socket while connecting
+    if (fd >= 0 && fd != new_fd) {
+        unlink(fd);
+        fd = -1;
+    }
+
+    if (new_fd < 0)
+        return;
+
+    if (fd < 0) {
+        fd = new_fd;
+        link(fd, events);
+    } else {
+        modify_link(fd, events);
+    }
+}
+
+int DriversListener::handle_event(int, uint32_t events, bool &)
+{
+    if (state == CONNECTING) {
+        on_connecting();
+        return 0;
+    }
+
+    if (events & EPOLLOUT) {
+        int ret = PQflush(conn);
+        if (ret < 0) {
+            err("drivers listener send failed: %s", PQerrorMessage(conn));
+            disconnect();
+            return -1;
+        }
+        if (ret == 0)
+            watch(EPOLLIN);
+    }
+
+    if (events & (EPOLLIN | EPOLLERR | EPOLLHUP))
+        on_result();
+
+    return 0;
+}
+
+void DriversListener::on_connecting()
+{
+    switch (PQconnectPoll(conn)) {
+    case PGRES_POLLING_READING:
+        watch(EPOLLIN);
+        break;
+    case PGRES_POLLING_WRITING:
+        watch(EPOLLOUT);
+        break;
+    case PGRES_POLLING_OK: {
+        info("drivers listener connected to database. backend pid: %d.",
+             PQbackendPID(conn));
+
+        char *ident = PQescapeIdentifier(conn, channel.c_str(), channel.size());
+        if (!ident) {
+            err("drivers listener channel '%s': %s",
+                channel.c_str(), PQerrorMessage(conn));
+            disconnect();
+            break;
+        }
+        string query = string("LISTEN ") + ident;
+        PQfreemem(ident);
+
+        state = SUBSCRIBING;
+        if (!send(query))
+            break;
+
+        // changes could be missed while disconnected
+        if (connected_once)
+            pending_all = true;
+        connected_once = true;
+    } break;
+    default:
+        dbg("drivers listener connection failed: %s", PQerrorMessage(conn));
+        disconnect();
+        break;
+    }
+}
+
+void DriversListener::on_result()
+{
+    if (!PQconsumeInput(conn)) {
+        err("drivers listener connection error: %s", PQerrorMessage(conn));
+        disconnect();
+        return;
+    }
+
+    on_notifications();
+    if (state == DISCONNECTED)
+        return;
+
+    while (!PQisBusy(conn)) {
+        PGresult *r = PQgetResult(conn);
+        if (!r) {
+            // query is complete
+            State finished = state;
+            state = IDLE;
+
+            if (finished == SUBSCRIBING) {
+                info("drivers listener is subscribed to '%s'", channel.c_str());
+            } else if (finished == LOADING) {
+                finish_loading();
+            }
+
+            // failed loading is repeated on the next notification
+            if (!loading_failed)
+                send_pending();
+            return;
+        }
+
+        switch (PQresultStatus(r)) {
+        case PGRES_COMMAND_OK:
+            break;
+        case PGRES_TUPLES_OK:
+            for (int row = 0; row < PQntuples(r); ++row) {
+                CRawConfig raw;
+                for (int col = 0; col < PQnfields(r); ++col) {
+                    if (PQgetisnull(r, row, col))
+                        raw.addNull(PQfname(r, col));
+                    else
+                        raw.add(PQfname(r, col), PQgetvalue(r, row, col));
+                }
+                configs.push_back(std::move(raw));
+            }
+            break;
+        default:
+            err("drivers listener query error: %s", PQresultErrorMessage(r));
+            if (state == SUBSCRIBING) {
+                PQclear(r);
+                disconnect();
+                return;
+            }
+            loading_failed = true;
+            break;
+        }
+        PQclear(r);
+    }
+}
+
+void DriversListener::on_notifications()
+{
+    while (PGnotify *n = PQnotifies(conn)) {
+        dbg("drivers listener notification: '%s'", n->extra);
+
+        bool has_ids = false;
+        const char *p = n->extra;
+        while (*p) {
+            char *end;
+            long id = strtol(p, &end, 10);
+            if (end == p) {
+                // skip separator
+                p++;
+                continue;
+            }
+            pending_ids.insert(static_cast<CDriverCfg::CfgUniqId_t>(id));
+            has_ids = true;
+            p = end;
+        }
+
+        if (!has_ids)
+            pending_all = true;
+
+        PQfreemem(n);
+    }
+
+    if (state == IDLE) {
+        loading_failed = false;
+        send_pending();
+    }
+}
+
+bool DriversListener::send(const std::string &query)
+{
+    if (!PQsendQuery(conn, query.c_str())) {
+        err("drivers listener query failed: %s", PQerrorMessage(conn));
+        disconnect();
+        return false;
+    }
+
+    int ret = PQflush(conn);
+    if (ret < 0) {
+        err("drivers listener send failed: %s", PQerrorMessage(conn));
+        disconnect();
+        return false;
+    }
+
+    watch(ret ? EPOLLIN | EPOLLOUT : EPOLLIN);
+
+    return true;
+}
+
+void DriversListener::send_pending()
+{
+    if (!pending_all && pending_ids.empty())
+        return;
+
+    loading_all = pending_all;
+    loading_ids.clear();
+    if (!loading_all)
+        loading_ids.swap(pending_ids);
+    pending_ids.clear();
+    pending_all = false;
+
+    configs.clear();
+    loading_failed = false;
+
+    state = LOADING;
+    send(LOAD_DRIVERS_QUERY);
+}
+
+void DriversListener::finish_loading()
+{
+    if (loading_failed) {
+        // keep the changes for the next notification or reconnect
+        pending_all |= loading_all;
+        pending_ids.insert(loading_ids.begin(), loading_ids.end());
+    } else {
+        info("drivers configuration is changed: %s",
+             loading_all ? "all databases" :
+             (std::to_string(loading_ids.size()) + " databases").c_str());
+        on_changed(configs, loading_all ? Ids() : loading_ids);
+    }
+
+    loading_ids.clear();
+    loading_all = false;
+    configs.clear();
+}
+
+void DriversListener::on_timer()
+{
+    if (state == DISCONNECTED)
+        connect();
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "dispatcher/EventHandler.h"
+#include "dispatcher/Timer.h"
+#include "drivers/DriverConfig.h"
+#include "drivers/RawConfig.h"
+
+#include <string>
+#include <vector>
+#include <set>
+#include <chrono>
+#include <functional>
+
+#include <libpq-fe.h>
+
+/**
+ * @brief Drivers configuration changes listener
+ *
+ * @note Holds the asynchronous libpq connection handled by the dispatcher
+ *       loop with LISTEN on 'drivers_notify_channel'. Notification payload
+ *       is the list of the changed database ids separated by commas or
+ *       spaces, empty payload means all databases. Configurations are
+ *       loaded by the same connection and passed to the callback with
+ *       the changed ids. Notifications missed while the connection is
+ *       down are covered by the full reload after reconnect
+ */
+class DriversListener : public EventHandler {
+public:
+    using Ids = std::set<CDriverCfg::CfgUniqId_t>;
+
+    // ids are empty for all databases
+    using Callback = std::function<void (const std::vector<CRawConfig> &configs,
+                                         const Ids &ids)>;
+
+    explicit DriversListener(Callback callback);
+    ~DriversListener();
+
+    bool is_enabled() const { return !channel.empty(); }
+
+    /* EventHandler overrides */
+    int handle_event(int fd, uint32_t events, bool &stop) override;
+
+private:
+    enum State {
+        DISCONNECTED,
+        CONNECTING,
+        SUBSCRIBING,
+        IDLE,
+        LOADING
+    };
+
+    void connect();
+    void disconnect();
+    void watch(uint32_t events);
+    void on_connecting();
+    void on_result();
+    void on_notifications();
+    bool send(const std::string &query);
+    void send_pending();
+    void finish_loading();
+
+    void on_timer();
+
+    std::string channel;
+    PGconn *conn;
+    int fd;
+    State state;
+    bool connected_once;
+
+    // changes to load, reload all databases if 'pending_all'
+    Ids pending_ids;
+    bool pending_all;
+
+    // changes being loaded
+    Ids loading_ids;
+    bool loading_all;
+    std::vector<CRawConfig> configs;
+    bool loading_failed;
+
+    Callback on_changed;
+    Timer timer;
+};
@@ -0,0 +1,167 @@
+#include "DriversLoader.h"
+#include "cfg.h"
+#include "log.h"
+
+#include <chrono>
+#include <pthread.h>
+
+DriversLoader::DriversLoader(Callback callback)
+  : stopping(false),
+    results_ready([this]() { on_results(); }),
+    on_loaded(callback)
+{}
+
+DriversLoader::~DriversLoader()
+{
+    {
+        guard(tasks_mutex);
+        stopping = true;
+        tasks.clear();
+        jobs.clear();
+        tasks_ready.set(true);
+    }
+
+    // wait for the drivers being created
+    for (auto &w : workers)
+        w.join();
+}
+
+/**
+ * @brief Queue drivers creation. Threads are started on the first call
+ */
+void DriversLoader::load(std::vector<Task> &&new_tasks)
+{
+    if (new_tasks.empty())
+        return;
+
+    guard(tasks_mutex);
+
+    for (auto &t : new_tasks)
+        tasks.emplace_back(std::move(t));
+    tasks_ready.set(true);
+
+    start_workers();
+}
+
+/**
+ * @brief Queue the job. Jobs are taken before the drivers creation
+ */
+void DriversLoader::submit(Job &&job)
+{
+    guard(tasks_mutex);
+
+    jobs.emplace_back(std::move(job));
+    tasks_ready.set(true);
+
+    start_workers();
+}
+
+// called under tasks_mutex
+void DriversLoader::start_workers()
+{
+    while (workers.size() < cfg.db.drivers_load_threads)
+        workers.emplace_back(&DriversLoader::run, this);
+}
+
+bool DriversLoader::next_task(Task &task, Job &job)
+{
+    while (true) {
+        tasks_ready.wait_for();
+
+        guard(tasks_mutex);
+        if (stopping)
+            return false;
+
+        if (!jobs.empty()) {
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            return true;
+        }
+
+        if (tasks.empty()) {
+            // load() sets it under the same mutex, so wakeup is not lost
+            tasks_ready.set(false);
+            continue;
+        }
+
+        task = std::move(tasks.front());
+        tasks.pop_front();
+        return true;
+    }
+}
+
+void DriversLoader::build(const Task &task)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<CDriver> driver;
+
+    try {
+        driver = CDriver::instantiate(task.config);
+        if (!driver)
+            warn("Not supported driver provided for id %d", task.id);
+    } catch (const CRawConfig::error &e) {
+        // missed or invalid columns
+        err("Driver raw config [%d]: %s", task.id, e.what());
+    } catch (const CDriverCfg::error &e) {
+        err("Driver config [%s]: %s", e.getIdent(), e.what());
+    } catch (...) {
+        err("Unexpected driver loading exception for id %d", task.id);
+    }
+
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    {
+        guard(results_mutex);
+        results.push_back({ task, std::move(driver), elapsed.count() });
+    }
+    results_ready.notify();
+}
+
+void DriversLoader::complete(Completion &&completion)
+{
+    {
+        guard(results_mutex);
+        completions.emplace_back(std::move(completion));
+    }
+    results_ready.notify();
+}
+
+/**
+ * @brief Pass the created drivers to the callback (dispatcher thread)
+ */
+void DriversLoader::on_results()
+{
+    std::deque<Result> ready;
+    std::deque<Completion> done;
+    {
+        guard(results_mutex);
+        ready.swap(results);
+        done.swap(completions);
+    }
+
+    for (auto &r : ready)
+        on_loaded(r.task, std::move(r.driver), r.load_time);
+    for (auto &c : done)
+        if (c) c();
+}
+
+void DriversLoader::run()
+{
+    pthread_setname_np(pthread_self(), "drv-loader");
+
+    Task task;
+    Job job;
+    while (next_task(task, job)) {
+        if (job) {
+            try {
+                complete(job());
+            } catch (...) {
+                err("Unexpected loader job exception");
+            }
+            job = nullptr;
+        } else {
+            build(task);
+        }
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "thread.h"
+#include "drivers/Driver.h"
+#include "drivers/RawConfig.h"
+#include "dispatcher/Notifier.h"
+
+#include <deque>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <functional>
+
+/**
+ * @brief Parallel drivers creation
+ *
+ * @note Drivers are created by the pool of 'drivers_load_threads'
+ *       threads, so the resolver serves requests for the already
+ *       created drivers while the large databases (e.g. CSV indexes)
+ *       are being loaded. Loader threads only create drivers, the
+ *       callback is called on the dispatcher thread, with null driver
+ *       if its creation is failed. So drivers are put in service and
+ *       released on the dispatcher thread only. Other blocking jobs
+ *       (e.g. configuration loading) are run by the same pool, their
+ *       completion is called on the dispatcher thread as well
+ */
+class DriversLoader {
+public:
+    struct Task {
+        CDriverCfg::CfgUniqId_t id;
+        size_t hash;                // configuration hash
+        CRawConfig config;
+    };
+
+    using Callback = std::function<void (const Task &task,
+                                         std::unique_ptr<CDriver> driver,
+                                         double load_time)>;
+
+    // job returns its completion called on the dispatcher thread
+    using Completion = std::function<void ()>;
+    using Job = std::function<Completion ()>;
+
+    explicit DriversLoader(Callback callback);
+    ~DriversLoader();
+
+    void load(std::vector<Task> &&new_tasks);
+    void submit(Job &&job);
+
+private:
+    struct Result {
+        Task task;
+        std::unique_ptr<CDriver> driver;
+        double load_time;
+    };
+
+    void run();
+    void start_workers();
+    bool next_task(Task &task, Job &job);
+    void build(const Task &task);
+    void complete(Completion &&completion);
+    void on_results();
+
+    mutex tasks_mutex;
+    std::deque<Task> tasks;
+    std::deque<Job> jobs;
+    condition<bool> tasks_ready;
+    bool stopping;
+
+    mutex results_mutex;
+    std::deque<Result> results;
+    std::deque<Completion> completions;
+    Notifier results_ready;
+
+    std::vector<std::thread> workers;
+    Callback on_loaded;
+};
@@ -3,12 +3,16 @@
 #include "cache.h"
 #include "drivers/Driver.h"
 #include "drivers/DriverConfig.h"
+#include "statistics/prometheus/prometheus_exporter.h"
 
 #include <pqxx/pqxx>
 
 #define TAGGED_REQ_VERSION 0
 #define CNAM_REQ_VERSION 1
 
+#define KEEP_WARM_TICK_MS 1000
+#define PROBE_TIMEOUT_MS 5000
+
 static const char * sLoadLNPConfigSTMT = "SELECT * FROM load_lnp_databases()";
 
 #pragma pack(1)
@@ -135,23 +139,89 @@ void ResolverRequest::parse(const RecvData &recv_data)
 }
 
 Resolver::Resolver()
-  : http_client(this)
-{}
+  : http_client(this),
+    batch_seq(0),
+    batch_timer([this]() { on_batch_timer(); }),
+    cache_fallback([this](CacheFallback::Lookup &l) { on_cache_fallback_finished(l); }),
+    drivers_loader([this](const DriversLoader::Task &t, unique_ptr<CDriver> d, double time)
+                   { on_driver_loaded(t, std::move(d), time); saveLoadedConfigs(); }),
+    drivers_listener([this](const vector<CRawConfig> &c, const DriversListener::Ids &ids)
+                     { on_drivers_changed(c, ids); }),
+    reload_notifier([this]() { on_reload(); }),
+    keep_warm_timer([this]() { on_keep_warm_timer(); })
+{
+    keep_warm_timer.start(KEEP_WARM_TICK_MS);
+}
 
 /**
- * @brief Load resolver drivers configuration from database table
+ * @brief Load resolver drivers configuration
+ *
+ * @note Configuration is loaded from the database and saved to
+ *       'drivers_config_file' after drivers are created. The file is
+ *       used when the database is unavailable, or as the only source
+ *       if 'drivers_config_source' is 'file'
  *
- * @param[in,out] dbMap   The map of the successfully loaded drivers
+ * @param[in,out] configs       The loaded configurations
+ * @param[out]    fromDatabase  Configurations are loaded from database
  *
  * @return boolean value as a loading procedure status
  */
-bool Resolver::loadResolveDrivers(Database_t & dbMap)
+bool Resolver::loadResolveConfigs(vector<CRawConfig> & configs, bool & fromDatabase)
+{
+  const string & filePath = cfg.db.drivers_config_file;
+  fromDatabase = !cfg.db.drivers_config_from_file;
+
+  if (fromDatabase && !loadDatabaseConfigs(configs))
+  {
+    if (filePath.empty())
+    {
+      return false;
+    }
+
+    warn("use last known good drivers configuration from '%s'", filePath.c_str());
+    fromDatabase = false;
+  }
+
+  if (!fromDatabase && !loadFileConfigs(configs))
+  {
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * @brief Save drivers configuration as the last known good one
+ *
+ * @param[in] configs   The configurations of the created drivers
+ */
+void Resolver::saveResolveConfigs(const vector<CRawConfig> & configs)
 {
-  // Status about successfully loaded
-  // database and initialized resolvers map
-  bool rv = false;
+  const string & filePath = cfg.db.drivers_config_file;
+  if (filePath.empty())
+  {
+    return;
+  }
+
+  try
+  {
+    CRawConfig::saveFile(filePath.c_str(), configs);
+  }
+  catch (const CRawConfig::error & e)
+  {
+    err("Drivers configuration saving: %s", e.what());
+  }
+}
 
-  // Try to load drivers from database configuration
+/**
+ * @brief Load drivers configuration from database table
+ *
+ * @param[in,out] configs   The loaded configurations
+ *
+ * @return boolean value as a loading procedure status
+ */
+bool Resolver::loadDatabaseConfigs(vector<CRawConfig> & configs)
+{
   try
   {
     pqxx::result dbResult;
@@ -163,62 +233,435 @@ bool Resolver::loadResolveDrivers(Database_t & dbMap)
 
     for (pqxx::result::size_type i = 0; i < dbResult.size(); ++i)
     {
-      const pqxx::row & dbResultRaw = dbResult[i];
-      unique_ptr<CDriver> drv = CDriver::instantiate(dbResultRaw);
-      if (drv)
+      CRawConfig raw;
+      for (const auto & field : dbResult[i])
       {
-        dbMap.emplace(drv->getUniqueId(), std::move(drv));
+        if (field.is_null())
+          raw.addNull(field.name());
+        else
+          raw.add(field.name(), field.c_str());
       }
-      else
+      configs.push_back(std::move(raw));
+    }
+
+    return true;
+  }
+  catch (const pqxx::pqxx_exception & e)
+  {
+    // show pqxx exception messages
+    err("pqxx_exception: %s ", e.base().what());
+  }
+  catch (...)
+  {
+    err("Unexpected drivers configuration loading exception");
+  }
+
+  return false;
+}
+
+/**
+ * @brief Load drivers configuration from the local JSON file
+ *
+ * @param[in,out] configs   The loaded configurations
+ *
+ * @return boolean value as a loading procedure status
+ */
+bool Resolver::loadFileConfigs(vector<CRawConfig> & configs)
+{
+  try
+  {
+    configs = CRawConfig::loadFile(cfg.db.drivers_config_file.c_str());
+    return true;
+  }
+  catch (const CRawConfig::error & e)
+  {
+    err("Drivers configuration loading: %s", e.what());
+  }
+
+  return false;
+}
+
+/**
+ * @brief Update drivers set by the configurations
+ *
+ * @note Driver with the same unique identifier and configuration hash
+ *       as the current or being loaded one is kept as is. New and
+ *       changed drivers are queued to be created by the loader, the
+ *       changed ones serve requests with the previous configuration
+ *       until the new driver is created. Removed drivers are released
+ *
+ * @param[in]  configs  The drivers configurations
+ * @param[out] tasks    The drivers to create
+ * @param[in]  scope    The drivers ids to update, null for all drivers
+ *
+ * @return boolean value as a configurations processing status
+ */
+bool Resolver::updateDrivers(const vector<CRawConfig> & configs,
+                             vector<DriversLoader::Task> & tasks,
+                             const DriversListener::Ids * scope)
+{
+  DriversHash_t hashes;
+  // configuration index by driver id
+  vector<std::pair<size_t, CDriverCfg::CfgUniqId_t> > rows;
+
+  try
+  {
+    for (size_t i = 0; i < configs.size(); ++i)
+    {
+      if (ECDriverId::ERESOLVER_DRIVER_NULL == CDriverCfg::getID(configs[i]))
       {
         warn("Not supported driver provided in the raw %lu", i);
+        continue;
+      }
+
+      const CDriverCfg::CfgUniqId_t id = CDriverCfg::getConfigUniqId(configs[i]);
+      if (-1 == id)
+      {
+        warn("Not found driver unique identifier in the raw %lu", i);
+        continue;
+      }
+
+      if (scope && !scope->count(id))
+      {
+        continue;
+      }
+
+      if (!hashes.emplace(id, configs[i].hash()).second)
+      {
+        warn("Duplicated driver unique identifier %d in the raw %lu", id, i);
+        continue;
+      }
+      rows.emplace_back(i, id);
+    }
+  }
+  catch (const CRawConfig::error & e)
+  {
+    // show raw configuration errors (missed or invalid columns)
+    err("Driver raw config: %s", e.what());
+    return false;
+  }
+
+  // released out of the mutex
+  Database_t removed;
+  size_t unchanged = 0;
+
+  {
+    guard(mDriversMutex);
+
+    for (const auto & row : rows)
+    {
+      const CDriverCfg::CfgUniqId_t id = row.second;
+      const size_t hash = hashes[id];
+
+      auto loading = mLoadingDrivers.find(id);
+      auto current = mDriversHashes.find(id);
+      const bool isCurrent = current != mDriversHashes.end() && current->second == hash;
+
+      if (loading != mLoadingDrivers.end())
+      {
+        if (loading->second == hash)
+        {
+          unchanged++;
+          continue;
+        }
+        // result of the previous configuration loading is dropped
+        mLoadingDrivers.erase(loading);
+      }
+
+      if (isCurrent)
+      {
+        unchanged++;
+        continue;
+      }
+
+      mLoadingDrivers.emplace(id, hash);
+      tasks.push_back({ id, hash, configs[row.first] });
+
+      if (!mDriversMap.count(id))
+      {
+        prometheus_exporter::instance()->driver_ready_changed(id, false);
+      }
+    }
+
+    // drivers out of the scope are kept as is
+    auto isKept = [&hashes, scope] (CDriverCfg::CfgUniqId_t id)
+      { return hashes.count(id) || (scope && !scope->count(id)); };
+
+    for (auto it = mDriversMap.begin(); it != mDriversMap.end(); )
+    {
+      if (isKept(it->first))
+      {
+        ++it;
+        continue;
       }
+
+      prometheus_exporter::instance()->driver_ready_changed(it->first, false);
+      mDriversHashes.erase(it->first);
+      last_probes.erase(it->first);
+      removed.emplace(it->first, std::move(it->second));
+      it = mDriversMap.erase(it);
     }
 
-    // Show information about loaded drivers
-    info("Loaded %lu drivers with %s", dbMap.size(), CDriverCfg::getFormatStrType());
-    for (const auto & i : dbMap)
+    for (auto it = mLoadingDrivers.begin(); it != mLoadingDrivers.end(); )
     {
-      i.second->showInfo();
+      if (isKept(it->first))
+        ++it;
+      else
+        it = mLoadingDrivers.erase(it);
+    }
+
+    for (auto it = mFailedDrivers.begin(); it != mFailedDrivers.end(); )
+    {
+      if (isKept(*it))
+        ++it;
+      else
+        it = mFailedDrivers.erase(it);
     }
-    rv = true;
   }
-  catch (const pqxx::pqxx_exception & e)
+
+  info("Loaded %lu drivers configurations with %s: %lu to create, %lu unchanged, %lu removed",
+       hashes.size(), CDriverCfg::getFormatStrType(),
+       tasks.size(), unchanged, removed.size());
+
+  return true;
+}
+
+/**
+ * @brief Loader callback for the created driver
+ *
+ * @note Called on the dispatcher thread. Driver is dropped if its
+ *       configuration is changed or removed while it was created
+ */
+void Resolver::on_driver_loaded(const DriversLoader::Task & task,
+                                unique_ptr<CDriver> driver,
+                                double load_time)
+{
+  // previous or dropped driver is released out of the mutex
+  unique_ptr<CDriver> released;
+
+  prometheus_exporter::instance()->driver_loaded(task.id, load_time);
+
+  guard(mDriversMutex);
+
+  auto loading = mLoadingDrivers.find(task.id);
+  if (loading == mLoadingDrivers.end() || loading->second != task.hash)
   {
-    // show pqxx exception messages
-    err("pqxx_exception: %s ", e.base().what());
+    dbg("drop outdated driver for id %d", task.id);
+    released = std::move(driver);
+    return;
   }
-  catch (const CDriverCfg::error & e)
+  mLoadingDrivers.erase(loading);
+
+  if (!driver)
   {
-    // show driver configuration error (abort main process)
-    err("Driver config [%s]: %s", e.getIdent(), e.what());
+    err("Driver %d is not created in %.2f ms%s", task.id, load_time,
+        mDriversMap.count(task.id) ? ", previous configuration is used" : "");
+    // configurations are not the last known good ones until it is created
+    mFailedDrivers.insert(task.id);
+    return;
   }
-  catch (...)
+  mFailedDrivers.erase(task.id);
+
+  info("Driver '%s/%d' is created in %.2f ms",
+       driver->getName(), task.id, load_time);
+  driver->showInfo();
+
+  driver->activate();
+
+  unique_ptr<CDriver> & current = mDriversMap[task.id];
+  released = std::move(current);
+  current = std::move(driver);
+  mDriversHashes[task.id] = task.hash;
+
+  // warm up connections on the next keep-warm timer tick
+  last_probes.erase(task.id);
+
+  prometheus_exporter::instance()->driver_ready_changed(task.id, true);
+}
+
+/**
+ * @brief Save the configurations once their drivers are created
+ *
+ * @note Configurations replace the ones waiting for the drivers
+ *       of the previous update
+ *
+ * @param[in] configs   The drivers configurations loaded from database
+ */
+void Resolver::saveConfigsWhenLoaded(const vector<CRawConfig> & configs)
+{
+  {
+    guard(mDriversMutex);
+    mSavingConfigs = configs;
+    mSavingPending = true;
+  }
+
+  // saved at once if there are no drivers to create
+  saveLoadedConfigs();
+}
+
+/**
+ * @brief Save the configurations as the last known good ones
+ *
+ * @note Saved when all queued drivers are created, not saved while
+ *       any driver is failed (by this or a previous update, until it
+ *       is created or removed), so the file keeps the previous ones
+ */
+void Resolver::saveLoadedConfigs()
+{
+  vector<CRawConfig> configs;
+
   {
-    // general exception handler (abort main process)
-    err("Unexpected driver loading exception");
+    guard(mDriversMutex);
+    if (!mSavingPending || !mLoadingDrivers.empty())
+    {
+      return;
+    }
+
+    mSavingPending = false;
+    configs.swap(mSavingConfigs);
+    if (!mFailedDrivers.empty())
+    {
+      warn("Drivers configuration is not saved: %zu drivers are not created",
+           mFailedDrivers.size());
+      return;
+    }
   }
 
-  return rv;
+  saveResolveConfigs(configs);
+}
+
+/**
+ * @brief Drivers listener callback for the changed configuration
+ *
+ * @note Only drivers with the notified ids are updated, configurations
+ *       of the other drivers are not compared
+ *
+ * @param[in] configs   All drivers configurations
+ * @param[in] ids       The changed drivers ids, empty for all drivers
+ */
+void Resolver::on_drivers_changed(const vector<CRawConfig> & configs,
+                                  const DriversListener::Ids & ids)
+{
+  vector<DriversLoader::Task> tasks;
+  if (!updateDrivers(configs, tasks, ids.empty() ? nullptr : &ids))
+  {
+    return;
+  }
+
+  drivers_loader.load(std::move(tasks));
+  saveConfigsWhenLoaded(configs);
 }
 
 /**
  * @brief Root method to load driver configuration
  *
+ * @note Configuration is loaded synchronously, it is used on startup.
+ *       Drivers are created by the loader in background, so the
+ *       method returns before the drivers are ready. Configurations
+ *       from database are saved to the file when the drivers are created
+ *
  * @return boolean status about loading result
  */
 bool Resolver::configure()
 {
-  Database_t dbMap;
-  bool rv = loadResolveDrivers(dbMap);
-  if (rv)
+  vector<CRawConfig> configs;
+  bool fromDatabase = false;
+  if (!loadResolveConfigs(configs, fromDatabase))
   {
-    //Mutex required for proper SIGHUP signal processing
+    return false;
+  }
+
+  return applyConfigs(configs, fromDatabase);
+}
+
+/**
+ * @brief Update drivers by the loaded configurations
+ *
+ * @param[in] configs       The loaded configurations
+ * @param[in] fromDatabase  Configurations are loaded from database
+ *
+ * @return boolean value as a configurations processing status
+ */
+bool Resolver::applyConfigs(const vector<CRawConfig> & configs, bool fromDatabase)
+{
+  vector<DriversLoader::Task> tasks;
+  if (!updateDrivers(configs, tasks))
+  {
+    return false;
+  }
+
+  drivers_loader.load(std::move(tasks));
+
+  if (fromDatabase)
+  {
+    saveConfigsWhenLoaded(configs);
+  }
+  else
+  {
+    // configurations waiting for the drivers are outdated
     guard(mDriversMutex);
-    mDriversMap.swap(dbMap);
+    mSavingPending = false;
+    mSavingConfigs.clear();
+  }
+
+  return true;
+}
+
+/**
+ * @brief Reload drivers configuration without blocking the dispatcher
+ *
+ * @note Safe to call from the signal handler. Configuration is loaded
+ *       by the loader pool, drivers and their dispatcher event handlers
+ *       are created and released by the dispatcher thread only
+ */
+void Resolver::reload()
+{
+  reload_notifier.notify();
+}
+
+/**
+ * @brief Start configuration loading by the loader pool (dispatcher thread)
+ * @note Reloads requested meanwhile are collapsed to the one more reload
+ */
+void Resolver::on_reload()
+{
+  if (mConfigsLoading)
+  {
+    mReloadPending = true;
+    return;
+  }
+  mConfigsLoading = true;
+
+  drivers_loader.submit([this]() -> DriversLoader::Completion {
+    auto configs = std::make_shared<vector<CRawConfig> >();
+    bool fromDatabase = false;
+    bool isLoaded = loadResolveConfigs(*configs, fromDatabase);
+
+    return [this, configs, fromDatabase, isLoaded]() {
+      on_configs_loaded(isLoaded, *configs, fromDatabase);
+    };
+  });
+}
+
+/**
+ * @brief Loaded configuration handler (dispatcher thread)
+ * @note Current drivers are kept if the configuration is not loaded
+ */
+void Resolver::on_configs_loaded(bool isLoaded, const vector<CRawConfig> & configs,
+                                 bool fromDatabase)
+{
+  mConfigsLoading = false;
+
+  if (!isLoaded || !applyConfigs(configs, fromDatabase))
+  {
+    err("Drivers configuration reload is failed, current drivers are kept");
   }
 
-  return rv;
+  if (mReloadPending)
+  {
+    mReloadPending = false;
+    on_reload();
+  }
 }
 
 /**
@@ -249,6 +692,11 @@ void Resolver::resolve(ResolverRequest &request)
 
     auto mapItem = mDriversMap.find(request.db_id);
     if (mapItem == mDriversMap.end()) {
+        if (mLoadingDrivers.count(request.db_id)) {
+            send_driver_error_reply(request,
+                ECErrorId::DRIVER_NOT_READY_ERROR, "database is not ready");
+            return;
+        }
         throw CResolverError(ECErrorId::GENERAL_RESOLVING_ERROR, "unknown database id");
     }
 
@@ -263,17 +711,26 @@ void Resolver::resolve(ResolverRequest &request)
 
     try {
         driver->requests_count_increment();
+
+        if (driver->getBatchSize() > 1) {
+            enqueue_batch(request, driver);
+            return;
+        }
+
         driver->resolve(request, this, this);
     } catch(const CDriver::error &e) {
         driver->requests_failed_increment();
-        throw CResolverError(ECErrorId::DRIVER_RESOLVING_ERROR, e.what());
+        send_driver_error_reply(request, ECErrorId::DRIVER_RESOLVING_ERROR, e.what());
+        return;
     } catch(const AsyncHttpClient::error &e) {
         driver->requests_failed_increment();
-        throw CResolverError(ECErrorId::GENERAL_RESOLVING_ERROR, e.what());
+        send_driver_error_reply(request, ECErrorId::GENERAL_RESOLVING_ERROR, e.what());
+        return;
     } catch(...) {
         driver->requests_failed_increment();
-        throw CResolverError(ECErrorId::GENERAL_RESOLVING_ERROR,
-                         "unknown resovling exception");
+        send_driver_error_reply(request, ECErrorId::GENERAL_RESOLVING_ERROR,
+                                "unknown resovling exception");
+        return;
     }
 
     if (request.is_done)
@@ -289,11 +746,133 @@ void Resolver::make_http_request(Resolver*,
     http_client.make_request(http_request);
 }
 
+void Resolver::make_http_batch_request(Resolver*,
+                                       vector<ResolverRequest> &requests,
+                                       const HttpRequest &http_request)
+{
+    HttpRequest batch_http_request(http_request);
+    batch_http_request.id = ++batch_seq;
+    batch_http_request.type = HTTP_REQUEST_BATCH;
+
+    http_client.make_request(batch_http_request);
+    waiting_batches.emplace(batch_http_request.id, std::move(requests));
+}
+
+/**
+ * @brief Add request to the driver pending batch.
+ *        Batch is flushed when it reaches driver batch size
+ *        or by timer after driver batch delay
+ */
+void Resolver::enqueue_batch(ResolverRequest &request, CDriver *driver)
+{
+    auto &batch = pending_batches[driver->getUniqueId()];
+
+    if (batch.requests.empty()) {
+        batch.deadline = std::chrono::steady_clock::now() +
+                         std::chrono::milliseconds(driver->getBatchDelay());
+        batch.requests.reserve(driver->getBatchSize());
+    }
+
+    batch.requests.emplace_back(std::move(request));
+
+    if (batch.requests.size() >= driver->getBatchSize()) {
+        vector<ResolverRequest> requests(std::move(batch.requests));
+        pending_batches.erase(driver->getUniqueId());
+        flush_batch(driver, requests);
+    }
+
+    arm_batch_timer();
+}
+
+void Resolver::flush_batch(CDriver *driver, vector<ResolverRequest> &requests)
+{
+    dbg("flush batch of %zu requests for '%s/%d'",
+        requests.size(), driver->getName(), driver->getUniqueId());
+
+    try {
+        driver->resolve_batch(requests, this, this);
+
+        // in-memory drivers resolve the batch immediately
+        for (auto &request : requests) {
+            if (request.is_done)
+                handle_request_is_done(request, driver);
+        }
+        return;
+    } catch(const CDriver::error &e) {
+        err("batch resolving exception: %s", e.what());
+        for (auto &request : requests) {
+            driver->requests_failed_increment();
+            send_driver_error_reply(request, ECErrorId::DRIVER_RESOLVING_ERROR, e.what());
+        }
+    } catch(const AsyncHttpClient::error &e) {
+        err("batch resolving exception: %s", e.what());
+        for (auto &request : requests) {
+            driver->requests_failed_increment();
+            send_driver_error_reply(request, ECErrorId::GENERAL_RESOLVING_ERROR, e.what());
+        }
+    }
+}
+
+void Resolver::on_batch_timer()
+{
+    auto now = std::chrono::steady_clock::now();
+
+    guard(mDriversMutex);
+
+    for (auto it = pending_batches.begin(); it != pending_batches.end();) {
+        if (it->second.deadline > now) {
+            ++it;
+            continue;
+        }
+
+        vector<ResolverRequest> requests(std::move(it->second.requests));
+        auto mapItem = mDriversMap.find(it->first);
+        it = pending_batches.erase(it);
+
+        if (mapItem == mDriversMap.end()) {
+            send_batch_error_reply(requests,
+                ECErrorId::GENERAL_RESOLVING_ERROR, "unknown database id");
+            continue;
+        }
+
+        flush_batch(mapItem->second.get(), requests);
+    }
+
+    arm_batch_timer();
+}
+
+void Resolver::arm_batch_timer()
+{
+    if (pending_batches.empty()) {
+        batch_timer.stop();
+        return;
+    }
+
+    auto deadline = pending_batches.begin()->second.deadline;
+    for (const auto &it : pending_batches)
+        deadline = std::min(deadline, it.second.deadline);
+
+    auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - std::chrono::steady_clock::now());
+
+    batch_timer.start(std::max<long>(timeout.count(), 0), false);
+}
+
 /**
  * @brief AsyncHttpClient handler func
  */
 void Resolver::on_http_response_received(AsyncHttpClient *, const HttpResponse &response)
 {
+    switch (response.type) {
+    case HTTP_REQUEST_PROBE:
+        on_http_probe_response(response);
+        return;
+    case HTTP_REQUEST_BATCH:
+        on_http_batch_response(response);
+        return;
+    default:
+        break;
+    }
 
     auto it = waiting_requests.find(response.id);
     if (it == waiting_requests.end()) {
@@ -338,11 +917,15 @@ void Resolver::parse_response(const HttpResponse &response,
             "request type is unsupported");
     }
 
+    // failed responses are counted too
+    if (response.is_connection_used)
+        driver->http_connection_increment(response.is_connection_reused);
+
     // check http response
     if (response.is_success == false) {
         dbg("http response error: %s", response.data.c_str());
         driver->requests_failed_increment();
-        throw CResolverError(ECErrorId::GENERAL_RESOLVING_ERROR, response.data.c_str());
+        send_driver_error_reply(request, ECErrorId::GENERAL_RESOLVING_ERROR, response.data);
         return;
     }
 
@@ -351,17 +934,96 @@ void Resolver::parse_response(const HttpResponse &response,
         request.is_done = true;
     } catch (const CDriver::error &e) {
         driver->requests_failed_increment();
-        throw CResolverError(ECErrorId::DRIVER_RESOLVING_ERROR, e.what());
+        send_driver_error_reply(request, ECErrorId::DRIVER_RESOLVING_ERROR, e.what());
+        return;
     } catch (...) {
         driver->requests_failed_increment();
-        throw CResolverError(ECErrorId::GENERAL_RESOLVING_ERROR,
-                         "unknown resovling exception");
+        send_driver_error_reply(request, ECErrorId::GENERAL_RESOLVING_ERROR,
+                                "unknown resovling exception");
+        return;
     }
 
     if (request.is_done)
         handle_request_is_done(request, driver);
 }
 
+void Resolver::on_http_batch_response(const HttpResponse &response)
+{
+    auto it = waiting_batches.find(response.id);
+    if (it == waiting_batches.end()) {
+        err("batch not found");
+        return;
+    }
+
+    vector<ResolverRequest> requests(std::move(it->second));
+    waiting_batches.erase(it);
+
+    try {
+        parse_batch_response(response, requests);
+    } catch(const CResolverError & e) {
+        err("got batch resolve exception: <%u> %s", static_cast<uint>(e.code()), e.what());
+
+        send_batch_error_reply(requests, e.code(), e.what());
+    }
+}
+
+void Resolver::parse_batch_response(const HttpResponse &response,
+                                    vector<ResolverRequest> &requests)
+{
+    if (requests.empty())
+        return;
+
+    //Mutex required to proper processing SIGHUP signal
+    guard(mDriversMutex);
+
+    auto mapItem = mDriversMap.find(requests.front().db_id);
+    if(mapItem == mDriversMap.end()) {
+        throw CResolverError(ECErrorId::GENERAL_RESOLVING_ERROR, "unknown database id");
+    }
+
+    CDriver *driver = mapItem->second.get();
+
+    auto fail_all = [this, &requests, driver](const ECErrorId code,
+                                              const string &description) {
+        for (auto &request : requests) {
+            driver->requests_failed_increment();
+            send_driver_error_reply(request, code, description);
+        }
+    };
+
+    // failed responses are counted too
+    if (response.is_connection_used)
+        driver->http_connection_increment(response.is_connection_reused);
+
+    // check http response
+    if (response.is_success == false) {
+        dbg("http batch response error: %s", response.data.c_str());
+        fail_all(ECErrorId::GENERAL_RESOLVING_ERROR, response.data);
+        return;
+    }
+
+    try {
+        driver->parse_batch(response.data, requests);
+    } catch (const CDriver::error &e) {
+        fail_all(ECErrorId::DRIVER_RESOLVING_ERROR, e.what());
+        return;
+    } catch (...) {
+        fail_all(ECErrorId::GENERAL_RESOLVING_ERROR,
+                 "unknown resovling exception");
+        return;
+    }
+
+    for (auto &request : requests) {
+        if (request.is_done) {
+            handle_request_is_done(request, driver);
+        } else {
+            driver->requests_failed_increment();
+            send_driver_error_reply(request, ECErrorId::DRIVER_RESOLVING_ERROR,
+                                    "no result in bulk reply");
+        }
+    }
+}
+
 void Resolver::handle_request_is_done(const ResolverRequest &request, CDriver *driver)
 {
 
@@ -391,12 +1053,134 @@ void Resolver::handle_request_is_done(const ResolverRequest &request, CDriver *d
     // cache result
     if(driver->getDriverType() == CDriver::DriverTypeTagged)
         lnp_cache::instance()->sync(
-            new cache_entry(driver->getUniqueId(), request.data, request.result));
+            driver->getUniqueId(), request.data, request.result);
 
     // reply to client
     send_reply(request);
 }
 
+/**
+ * @brief Reply to the request failed by the driver. Tagged request is
+ *        answered by the stale result from the database cache if
+ *        the cache fallback is enabled and the number is there
+ */
+void Resolver::send_driver_error_reply(const ResolverRequest &request,
+                                       const ECErrorId code,
+                                       const string &description)
+{
+    err("got resolve exception: <%u> %s", static_cast<uint>(code), description.c_str());
+
+    if (request.type == TAGGED_REQ_VERSION && cache_fallback.is_enabled()) {
+        cache_fallback.lookup(request, code, description);
+        return;
+    }
+
+    send_error_reply(request, code, description);
+}
+
+void Resolver::on_cache_fallback_finished(CacheFallback::Lookup &lookup)
+{
+    ResolverRequest &request = *lookup.request;
+
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - lookup.start;
+    prometheus_exporter::instance()->cache_fallback_finished(
+        lookup.is_found, lookup.is_timeout, elapsed.count());
+
+    if (!lookup.is_found) {
+        dbg("no cached result for %s%s", request.data.c_str(),
+            lookup.is_timeout ? " (timeout)" : "");
+        send_error_reply(request, lookup.code, lookup.description);
+        return;
+    }
+
+    dbg("Resolved (by cache, stale): %s -> %s (tag: '%s') [in %.2f ms]",
+        request.data.c_str(),
+        request.result.localRoutingNumber.c_str(),
+        request.result.localRoutingTag.c_str(),
+        elapsed.count());
+
+    send_reply(request);
+}
+
+/**
+ * @brief Keep-warm timer handler. Opens 'warm_connections' connections
+ *        for HTTP drivers after (re)configuration and repeats probes
+ *        each 'keep_warm_interval' seconds
+ */
+void Resolver::on_keep_warm_timer()
+{
+    auto now = std::chrono::steady_clock::now();
+
+    guard(mDriversMutex);
+
+    for (auto &it : mDriversMap) {
+        CDriver *driver = it.second.get();
+
+        const HttpConnOptions *opts = driver->getHttpConnOptions();
+        const char *url = driver->getHttpProbeUrl();
+        if (!opts || !opts->warm_connections || !url || !*url)
+            continue;
+
+        auto last = last_probes.find(driver->getUniqueId());
+        if (last == last_probes.end()) {
+            last_probes.emplace(driver->getUniqueId(), now);
+        } else {
+            if (!opts->keep_warm_interval ||
+                (now - last->second) < std::chrono::seconds(opts->keep_warm_interval))
+            {
+                continue;
+            }
+            last->second = now;
+        }
+
+        send_http_probes(driver, *opts, url);
+    }
+}
+
+void Resolver::send_http_probes(CDriver *driver,
+                                const HttpConnOptions &opts,
+                                const char *url)
+{
+    HttpRequest http_request;
+    http_request.id = driver->getUniqueId();
+    http_request.method = HEAD;
+    http_request.url = url;
+    http_request.verify_ssl = opts.verify_ssl;
+    http_request.timeout_ms = PROBE_TIMEOUT_MS;
+    http_request.conn_opts = &opts;
+    http_request.type = HTTP_REQUEST_PROBE;
+
+    dbg("send %u keep-warm probes for '%s/%d' to <%s>",
+        opts.warm_connections, driver->getName(), driver->getUniqueId(), url);
+
+    try {
+        for (unsigned int i = 0; i < opts.warm_connections; i++)
+            http_client.make_request(http_request);
+    } catch(const AsyncHttpClient::error &e) {
+        err("keep-warm probe for '%s/%d' failed: %s",
+            driver->getName(), driver->getUniqueId(), e.what());
+    }
+}
+
+void Resolver::on_http_probe_response(const HttpResponse &response)
+{
+    guard(mDriversMutex);
+
+    auto mapItem = mDriversMap.find(response.id);
+    if (mapItem == mDriversMap.end())
+        return;
+
+    CDriver *driver = mapItem->second.get();
+
+    if (!response.is_success) {
+        dbg("keep-warm probe for '%s/%d' failed: %s",
+            driver->getName(), driver->getUniqueId(), response.data.c_str());
+    }
+
+    driver->http_probe_finished(response.is_success, response.total_time_ms);
+}
+
 void Resolver::send_provisional_reply(const ResolverRequest &request)
 {
     transport::instance()->send_data(
@@ -464,6 +1248,14 @@ void Resolver::send_error_reply(const ResolverRequest &request,
     }
 }
 
+void Resolver::send_batch_error_reply(const vector<ResolverRequest> &requests,
+                                      const ECErrorId code,
+                                      const string &description)
+{
+    for (const auto &request : requests)
+        send_error_reply(request, code, description);
+}
+
 void Resolver::send_tagged_error_reply(const ResolverRequest &request,
                                        const ECErrorId code,
                                        const string &description)
@@ -7,6 +7,7 @@ using std::string;
 using std::unique_ptr;
 
 #include <map>
+#include <vector>
 #include <utility>
 #include <chrono>
 
@@ -15,6 +16,11 @@ using std::unique_ptr;
 #include "ResolverException.h"
 #include "transport/Transport.h"
 #include "drivers/modules/AsyncHttpClient.h"
+#include "dispatcher/Timer.h"
+#include "dispatcher/Notifier.h"
+#include "CacheFallback.h"
+#include "DriversLoader.h"
+#include "DriversListener.h"
 
 /**
  * @brief Forward declaration for singleton driver type define
@@ -45,6 +51,9 @@ public:
     virtual void make_http_request(Resolver* resolver,
                                    const ResolverRequest &request,
                                    const HttpRequest &http_request) = 0;
+    virtual void make_http_batch_request(Resolver* resolver,
+                                         vector<ResolverRequest> &requests,
+                                         const HttpRequest &http_request) = 0;
 };
 
 /**
@@ -60,6 +69,7 @@ public:
     ~Resolver() = default;
 
     bool configure();
+    void reload();
 
     /* TransportHandler */
     virtual void on_data_received(Transport *transport,
@@ -73,6 +83,9 @@ public:
     virtual void make_http_request(Resolver* resolver,
                                    const ResolverRequest &request,
                                    const HttpRequest &http_request) override;
+    virtual void make_http_batch_request(Resolver* resolver,
+                                         vector<ResolverRequest> &requests,
+                                         const HttpRequest &http_request) override;
 
     static void send_reply(const ResolverRequest &request);
 
@@ -84,9 +97,46 @@ private:
 
     void handle_request_is_done(const ResolverRequest &request, CDriver *driver);
 
+    void send_driver_error_reply(const ResolverRequest &request,
+                                 const ECErrorId code,
+                                 const string &description);
+    void on_cache_fallback_finished(CacheFallback::Lookup &lookup);
+
+    void enqueue_batch(ResolverRequest &request, CDriver *driver);
+    void flush_batch(CDriver *driver, vector<ResolverRequest> &requests);
+    void on_batch_timer();
+    void arm_batch_timer();
+    void on_http_batch_response(const HttpResponse &response);
+    void parse_batch_response(const HttpResponse &response,
+                              vector<ResolverRequest> &requests);
+
+    void on_keep_warm_timer();
+    void send_http_probes(CDriver *driver,
+                          const HttpConnOptions &opts,
+                          const char *url);
+    void on_http_probe_response(const HttpResponse &response);
+
     // Databases type defines
     using Database_t = std::map<CDriverCfg::CfgUniqId_t, unique_ptr<CDriver> >;
-    static bool loadResolveDrivers(Database_t & db);
+    using DriversHash_t = std::map<CDriverCfg::CfgUniqId_t, size_t>;
+    static bool loadResolveConfigs(vector<CRawConfig> & configs, bool & fromDatabase);
+    static void saveResolveConfigs(const vector<CRawConfig> & configs);
+    static bool loadDatabaseConfigs(vector<CRawConfig> & configs);
+    static bool loadFileConfigs(vector<CRawConfig> & configs);
+    bool updateDrivers(const vector<CRawConfig> & configs,
+                       vector<DriversLoader::Task> & tasks,
+                       const DriversListener::Ids * scope = nullptr);
+    void on_drivers_changed(const vector<CRawConfig> & configs,
+                            const DriversListener::Ids & ids);
+    void on_driver_loaded(const DriversLoader::Task & task,
+                          unique_ptr<CDriver> driver,
+                          double load_time);
+    bool applyConfigs(const vector<CRawConfig> & configs, bool fromDatabase);
+    void on_reload();
+    void on_configs_loaded(bool isLoaded, const vector<CRawConfig> & configs,
+                           bool fromDatabase);
+    void saveConfigsWhenLoaded(const vector<CRawConfig> & configs);
+    void saveLoadedConfigs();
 
     static void send_provisional_reply(const ResolverRequest &request);
     static void send_tagged_reply(const ResolverRequest &request);
@@ -95,6 +145,9 @@ private:
     static void send_error_reply(const ResolverRequest &request,
                                  const ECErrorId code,
                                  const string &description);
+    static void send_batch_error_reply(const vector<ResolverRequest> &requests,
+                                       const ECErrorId code,
+                                       const string &description);
     static void send_tagged_error_reply(const ResolverRequest &request,
                                         const ECErrorId code,
                                         const string &description);
@@ -103,9 +156,34 @@ private:
                                       const string &description);
 
     Database_t mDriversMap;
+    DriversHash_t mDriversHashes;   // configuration hash by driver id
+    DriversHash_t mLoadingDrivers;  // drivers being created by the loader
+    vector<CRawConfig> mSavingConfigs;  // saved once the drivers are created
+    bool mSavingPending = false;
+    DriversListener::Ids mFailedDrivers;  // not created drivers, configs are not saved
+    bool mConfigsLoading = false;   // reload is in progress (dispatcher thread)
+    bool mReloadPending = false;
     mutex mDriversMutex;
 
     AsyncHttpClient http_client;
     map<uint32_t, ResolverRequest> waiting_requests;
+
+    // requests collected for bulk lookup by driver id
+    struct PendingBatch {
+        vector<ResolverRequest> requests;
+        std::chrono::steady_clock::time_point deadline;
+    };
+    map<CDriverCfg::CfgUniqId_t, PendingBatch> pending_batches;
+    map<uint32_t, vector<ResolverRequest>> waiting_batches;
+    uint32_t batch_seq;
+    Timer batch_timer;
+
+    CacheFallback cache_fallback;
+    DriversLoader drivers_loader;
+    DriversListener drivers_listener;
+    Notifier reload_notifier;
+
+    Timer keep_warm_timer;
+    map<CDriverCfg::CfgUniqId_t, std::chrono::steady_clock::time_point> last_probes;
 };
 
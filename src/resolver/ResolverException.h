@@ -26,6 +26,7 @@ enum class ECErrorId : uint8_t
   // Resolving general and driers error - 2X
   ,GENERAL_RESOLVING_ERROR = 21
   ,DRIVER_RESOLVING_ERROR  = 22
+  ,DRIVER_NOT_READY_ERROR  = 23
 };
 
 /**
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Bounded lock-free queue of values (D. Vyukov's MPMC ring)
+ *
+ * @note Values are kept in the preallocated cells and exchanged with
+ *       the caller objects by swap(), so the strings capacity is reused
+ *       and push/pop do not allocate once the cells are warmed up.
+ *       Pop is safe for several consumers, so producers could evict
+ *       the oldest value on overflow
+ */
+template<class T>
+class ring_queue {
+	struct cell {
+		std::atomic<size_t> seq;
+		T data;
+	};
+
+	std::unique_ptr<cell[]> buf;
+	size_t mask;
+
+	alignas(64) std::atomic<size_t> enqueue_pos;
+	alignas(64) std::atomic<size_t> dequeue_pos;
+
+  public:
+	/* capacity is rounded up to the power of 2 */
+	explicit ring_queue(size_t capacity)
+	  : enqueue_pos(0),
+		dequeue_pos(0)
+	{
+		size_t size = 2;
+		while(size < capacity) size <<= 1;
+
+		buf.reset(new cell[size]);
+		mask = size - 1;
+		for(size_t i = 0; i < size; i++)
+			buf[i].seq.store(i, std::memory_order_relaxed);
+	}
+
+	ring_queue(const ring_queue &) = delete;
+	ring_queue &operator=(const ring_queue &) = delete;
+
+	/**
+	 * @brief Push value filled in place by fill(T &)
+	 *
+	 * @return false if the queue is full
+	 */
+	template<class F>
+	bool try_push(F &&fill)
+	{
+		cell *c;
+		size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+		for(;;) {
+			c = &buf[pos & mask];
+			size_t seq = c->seq.load(std::memory_order_acquire);
+			intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+			if(dif == 0) {
+				if(enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					break;
+			} else if(dif < 0) {
+				return false;
+			} else {
+				pos = enqueue_pos.load(std::memory_order_relaxed);
+			}
+		}
+
+		fill(c->data);
+		c->seq.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * @brief Pop the oldest value swapping it with out
+	 *
+	 * @return false if the queue is empty
+	 */
+	bool try_pop(T &out)
+	{
+		cell *c;
+		size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+		for(;;) {
+			c = &buf[pos & mask];
+			size_t seq = c->seq.load(std::memory_order_acquire);
+			intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+			if(dif == 0) {
+				if(dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					break;
+			} else if(dif < 0) {
+				return false;
+			} else {
+				pos = dequeue_pos.load(std::memory_order_relaxed);
+			}
+		}
+
+		using std::swap;
+		swap(out, c->data);
+		c->seq.store(pos + mask + 1, std::memory_order_release);
+		return true;
+	}
+
+	/* approximate values count */
+	size_t size() const
+	{
+		size_t head = dequeue_pos.load(std::memory_order_relaxed);
+		size_t tail = enqueue_pos.load(std::memory_order_relaxed);
+		return tail > head ? tail - head : 0;
+	}
+
+	size_t capacity() const { return mask + 1; }
+};
@@ -11,8 +11,8 @@ void sig_handler(int sig)
 
   if (SIGHUP == sig)
   {
-    // Reload driver configurations
-    resolver::instance()->configure();
+    // Reload driver configurations on the dispatcher thread
+    resolver::instance()->reload();
     return;
   }
 
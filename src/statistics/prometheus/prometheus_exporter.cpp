@@ -83,6 +83,209 @@ void PrometheusExporter::start()
 		.Labels(static_labels)
 		.Register(*registry);
 
+	// create driver_http_connections_new
+	driver_http_connections_new = &BuildCounter()
+		.Name(METRICS_PREFIX "driver_http_connections_new")
+		.Help("HTTP requests which established a new connection")
+		.Labels(static_labels)
+		.Register(*registry);
+
+	// create driver_http_connections_reused
+	driver_http_connections_reused = &BuildCounter()
+		.Name(METRICS_PREFIX "driver_http_connections_reused")
+		.Help("HTTP requests served over an already opened connection")
+		.Labels(static_labels)
+		.Register(*registry);
+
+	// create driver_http_probes
+	driver_http_probes = &BuildCounter()
+		.Name(METRICS_PREFIX "driver_http_probes")
+		.Help("Keep-warm probes count")
+		.Labels(static_labels)
+		.Register(*registry);
+
+	// create driver_http_probes_failed
+	driver_http_probes_failed = &BuildCounter()
+		.Name(METRICS_PREFIX "driver_http_probes_failed")
+		.Help("Failed keep-warm probes count")
+		.Labels(static_labels)
+		.Register(*registry);
+
+	// create driver_http_probe_time
+	driver_http_probe_time = &BuildGauge()
+		.Name(METRICS_PREFIX "driver_http_probe_time")
+		.Help("Last successful keep-warm probe latency in ms")
+		.Labels(static_labels)
+		.Register(*registry);
+
+	// create driver_memory_usage
+	driver_memory_usage = &BuildGauge()
+		.Name(METRICS_PREFIX "driver_memory_usage")
+		.Help("In-memory lookup index size in bytes")
+		.Labels(static_labels)
+		.Register(*registry);
+
+	// create driver_index_generation
+	driver_index_generation = &BuildGauge()
+		.Name(METRICS_PREFIX "driver_index_generation")
+		.Help("In-memory lookup index reloads count")
+		.Labels(static_labels)
+		.Register(*registry);
+
+	// create driver_index_rows
+	driver_index_rows = &BuildGauge()
+		.Name(METRICS_PREFIX "driver_index_rows")
+		.Help("In-memory lookup index rows count")
+		.Labels(static_labels)
+		.Register(*registry);
+
+	// create driver_index_build_time
+	driver_index_build_time = &BuildGauge()
+		.Name(METRICS_PREFIX "driver_index_build_time")
+		.Help("Last in-memory lookup index build duration in ms")
+		.Labels(static_labels)
+		.Register(*registry);
+
+	// create driver_ready
+	driver_ready = &BuildGauge()
+		.Name(METRICS_PREFIX "driver_ready")
+		.Help("Driver is created and serves requests")
+		.Labels(static_labels)
+		.Register(*registry);
+
+	// create driver_load_time
+	driver_load_time = &BuildGauge()
+		.Name(METRICS_PREFIX "driver_load_time")
+		.Help("Last driver creation duration in ms")
+		.Labels(static_labels)
+		.Register(*registry);
+
+	// create cache_batches
+	cache_batches = &BuildCounter()
+		.Name(METRICS_PREFIX "cache_batches")
+		.Help("Cache writer batch commits count")
+		.Labels(static_labels)
+		.Register(*registry);
+
+	// create cache_entries
+	cache_entries = &BuildCounter()
+		.Name(METRICS_PREFIX "cache_entries")
+		.Help("Entries written to the cache")
+		.Labels(static_labels)
+		.Register(*registry);
+
+	// create cache_entries_failed
+	cache_entries_failed = &BuildCounter()
+		.Name(METRICS_PREFIX "cache_entries_failed")
+		.Help("Entries dropped by failed cache batch commits")
+		.Labels(static_labels)
+		.Register(*registry);
+
+	// create cache_commit_time
+	cache_commit_time = &BuildCounter()
+		.Name(METRICS_PREFIX "cache_commit_time")
+		.Help("Accumulated cache batch commit time in ms")
+		.Labels(static_labels)
+		.Register(*registry);
+
+	// create cache_batch_size
+	cache_batch_size = &BuildGauge()
+		.Name(METRICS_PREFIX "cache_batch_size")
+		.Help("Last cache batch entries count")
+		.Labels(static_labels)
+		.Register(*registry);
+
+	// create cache_writer_lag
+	cache_writer_lag = &BuildGauge()
+		.Name(METRICS_PREFIX "cache_writer_lag")
+		.Help("Queuing time of the oldest entry of the last committed batch in ms")
+		.Labels(static_labels)
+		.Register(*registry);
+
+	// create cache_queue_depth
+	cache_queue_depth = &BuildGauge()
+		.Name(METRICS_PREFIX "cache_queue_depth")
+		.Help("Entries waiting for the cache writer")
+		.Labels(static_labels)
+		.Register(*registry);
+
+	// create cache_queue_dropped
+	cache_queue_dropped = &BuildCounter()
+		.Name(METRICS_PREFIX "cache_queue_dropped")
+		.Help("Entries dropped on the cache queue overflow")
+		.Labels(static_labels)
+		.Register(*registry);
+
+	// create cache_entries_coalesced
+	cache_entries_coalesced = &BuildCounter()
+		.Name(METRICS_PREFIX "cache_entries_coalesced")
+		.Help("Entries replaced by the later result for the same number in the batch")
+		.Labels(static_labels)
+		.Register(*registry);
+
+	// create cache_entries_unchanged
+	cache_entries_unchanged = &BuildCounter()
+		.Name(METRICS_PREFIX "cache_entries_unchanged")
+		.Help("Entries not written as unchanged within the refresh interval")
+		.Labels(static_labels)
+		.Register(*registry);
+
+	// create cache_journal_pending
+	cache_journal_pending = &BuildGauge()
+		.Name(METRICS_PREFIX "cache_journal_pending")
+		.Help("Entries in the cache journal to be replayed")
+		.Labels(static_labels)
+		.Register(*registry);
+
+	// create cache_journal_segments
+	cache_journal_segments = &BuildGauge()
+		.Name(METRICS_PREFIX "cache_journal_segments")
+		.Help("Cache journal segment files")
+		.Labels(static_labels)
+		.Register(*registry);
+
+	// create cache_journal_spilled
+	cache_journal_spilled = &BuildCounter()
+		.Name(METRICS_PREFIX "cache_journal_spilled")
+		.Help("Entries appended to the cache journal")
+		.Labels(static_labels)
+		.Register(*registry);
+
+	// create cache_journal_replayed
+	cache_journal_replayed = &BuildCounter()
+		.Name(METRICS_PREFIX "cache_journal_replayed")
+		.Help("Entries written to the database from the cache journal")
+		.Labels(static_labels)
+		.Register(*registry);
+
+	// create cache_fallback_hits
+	cache_fallback_hits = &BuildCounter()
+		.Name(METRICS_PREFIX "cache_fallback_hits")
+		.Help("Failed requests replied by the stale result from the cache table")
+		.Labels(static_labels)
+		.Register(*registry);
+
+	// create cache_fallback_misses
+	cache_fallback_misses = &BuildCounter()
+		.Name(METRICS_PREFIX "cache_fallback_misses")
+		.Help("Failed requests without the result in the cache table")
+		.Labels(static_labels)
+		.Register(*registry);
+
+	// create cache_fallback_timeouts
+	cache_fallback_timeouts = &BuildCounter()
+		.Name(METRICS_PREFIX "cache_fallback_timeouts")
+		.Help("Cache table lookups not finished within the timeout")
+		.Labels(static_labels)
+		.Register(*registry);
+
+	// create cache_fallback_time
+	cache_fallback_time = &BuildCounter()
+		.Name(METRICS_PREFIX "cache_fallback_time")
+		.Help("Cache table lookups time in milliseconds")
+		.Labels(static_labels)
+		.Register(*registry);
+
 	// ask the exposer to scrape the registry on incoming HTTP requests
 	exposer->RegisterCollectable(registry);
 
@@ -96,6 +299,35 @@ void PrometheusExporter::stop()
 	driver_requests_count = NULL;
 	driver_requests_failed = NULL;
 	driver_requests_time = NULL;
+	driver_http_connections_new = NULL;
+	driver_http_connections_reused = NULL;
+	driver_http_probes = NULL;
+	driver_http_probes_failed = NULL;
+	driver_http_probe_time = NULL;
+	driver_memory_usage = NULL;
+	driver_index_generation = NULL;
+	driver_index_rows = NULL;
+	driver_index_build_time = NULL;
+	driver_ready = NULL;
+	driver_load_time = NULL;
+	cache_batches = NULL;
+	cache_entries = NULL;
+	cache_entries_failed = NULL;
+	cache_commit_time = NULL;
+	cache_batch_size = NULL;
+	cache_writer_lag = NULL;
+	cache_queue_depth = NULL;
+	cache_queue_dropped = NULL;
+	cache_entries_coalesced = NULL;
+	cache_entries_unchanged = NULL;
+	cache_journal_pending = NULL;
+	cache_journal_segments = NULL;
+	cache_journal_spilled = NULL;
+	cache_journal_replayed = NULL;
+	cache_fallback_hits = NULL;
+	cache_fallback_misses = NULL;
+	cache_fallback_timeouts = NULL;
+	cache_fallback_time = NULL;
 }
 
 
@@ -144,6 +376,150 @@ void PrometheusExporter::driver_requests_finished_increment(
 		driver_requests_time->Add(l).Increment(time_consumed);
 }
 
+void PrometheusExporter::driver_http_connection_increment(
+	const string &type,
+	CDriverCfg::CfgUniqId_t id,
+	const bool is_reused)
+{
+	std::lock_guard<std::mutex> lock{mutex_};
+
+	auto family = is_reused ?
+		driver_http_connections_reused : driver_http_connections_new;
+
+	if (family != nullptr)
+		family->Add(
+			{ {"type", type},
+			  {"id", std::to_string(id)}
+			}).Increment();
+}
+
+void PrometheusExporter::driver_http_probe_finished(
+	const string &type,
+	CDriverCfg::CfgUniqId_t id,
+	const bool is_success,
+	const double time_consumed)
+{
+	prometheus::Labels l({
+		{"type", type},
+		{"id", std::to_string(id) }
+	});
+
+	std::lock_guard<std::mutex> lock{mutex_};
+
+	if (driver_http_probes != nullptr)
+		driver_http_probes->Add(l).Increment();
+
+	if (!is_success) {
+		if (driver_http_probes_failed != nullptr)
+			driver_http_probes_failed->Add(l).Increment();
+		return;
+	}
+
+	if (driver_http_probe_time != nullptr)
+		driver_http_probe_time->Add(l).Set(time_consumed);
+}
+
+void PrometheusExporter::driver_index_loaded(
+	const string &type,
+	CDriverCfg::CfgUniqId_t id,
+	const unsigned long generation,
+	const size_t rows,
+	const size_t bytes,
+	const double build_time)
+{
+	prometheus::Labels l({
+		{"type", type},
+		{"id", std::to_string(id) }
+	});
+
+	std::lock_guard<std::mutex> lock{mutex_};
+
+	if (driver_memory_usage != nullptr)
+		driver_memory_usage->Add(l).Set(bytes);
+
+	if (driver_index_generation != nullptr)
+		driver_index_generation->Add(l).Set(generation);
+
+	if (driver_index_rows != nullptr)
+		driver_index_rows->Add(l).Set(rows);
+
+	if (driver_index_build_time != nullptr)
+		driver_index_build_time->Add(l).Set(build_time);
+}
+
+void PrometheusExporter::driver_ready_changed(
+	CDriverCfg::CfgUniqId_t id,
+	const bool is_ready)
+{
+	std::lock_guard<std::mutex> lock{mutex_};
+
+	if (driver_ready != nullptr)
+		driver_ready->Add({{"id", std::to_string(id)}}).Set(is_ready ? 1 : 0);
+}
+
+void PrometheusExporter::driver_loaded(
+	CDriverCfg::CfgUniqId_t id,
+	const double load_time)
+{
+	std::lock_guard<std::mutex> lock{mutex_};
+
+	if (driver_load_time != nullptr)
+		driver_load_time->Add({{"id", std::to_string(id)}}).Set(load_time);
+}
+
+void PrometheusExporter::cache_batch_committed(
+	const unsigned int writer,
+	const size_t entries,
+	const bool is_success,
+	const double commit_time,
+	const double lag)
+{
+	prometheus::Labels l({
+		{"writer", std::to_string(writer) }
+	});
+
+	std::lock_guard<std::mutex> lock{mutex_};
+
+	if (cache_batch_size != nullptr)
+		cache_batch_size->Add(l).Set(entries);
+
+	if (!is_success) {
+		if (cache_entries_failed != nullptr)
+			cache_entries_failed->Add(l).Increment(entries);
+		return;
+	}
+
+	if (cache_batches != nullptr)
+		cache_batches->Add(l).Increment();
+
+	if (cache_entries != nullptr)
+		cache_entries->Add(l).Increment(entries);
+
+	if (cache_commit_time != nullptr)
+		cache_commit_time->Add(l).Increment(commit_time);
+
+	if (cache_writer_lag != nullptr)
+		cache_writer_lag->Add(l).Set(lag);
+}
+
+void PrometheusExporter::cache_queue_stats(
+	const unsigned int writer,
+	const size_t depth,
+	const unsigned long dropped)
+{
+	prometheus::Labels l({
+		{"writer", std::to_string(writer) }
+	});
+
+	std::lock_guard<std::mutex> lock{mutex_};
+
+	if (cache_queue_depth != nullptr)
+		cache_queue_depth->Add(l).Set(depth);
+
+	if (cache_queue_dropped != nullptr)
+		cache_queue_dropped->Add(l).Increment(dropped);
+}
+
 void PrometheusExporter::driver_init_metrics(
 	const string &type,
 	CDriverCfg::CfgUniqId_t id)
@@ -166,4 +542,76 @@ void PrometheusExporter::driver_init_metrics(
 
 	if (driver_requests_time != nullptr)
 		driver_requests_time->Add(l);
+
+	if (driver_http_connections_new != nullptr)
+		driver_http_connections_new->Add(l);
+
+	if (driver_http_connections_reused != nullptr)
+		driver_http_connections_reused->Add(l);
+}
+
+void PrometheusExporter::cache_entries_skipped(
+	const unsigned int writer,
+	const size_t coalesced,
+	const size_t unchanged)
+{
+	prometheus::Labels l({
+		{"writer", std::to_string(writer) }
+	});
+
+	std::lock_guard<std::mutex> lock{mutex_};
+
+	if (coalesced && cache_entries_coalesced != nullptr)
+		cache_entries_coalesced->Add(l).Increment(coalesced);
+
+	if (unchanged && cache_entries_unchanged != nullptr)
+		cache_entries_unchanged->Add(l).Increment(unchanged);
+}
+
+void PrometheusExporter::cache_journal_stats(
+	const unsigned int writer,
+	const size_t pending,
+	const size_t segments,
+	const unsigned long spilled,
+	const unsigned long replayed)
+{
+	prometheus::Labels l({
+		{"writer", std::to_string(writer) }
+	});
+
+	std::lock_guard<std::mutex> lock{mutex_};
+
+	if (cache_journal_pending != nullptr)
+		cache_journal_pending->Add(l).Set(pending);
+
+	if (cache_journal_segments != nullptr)
+		cache_journal_segments->Add(l).Set(segments);
+
+	if (cache_journal_spilled != nullptr)
+		cache_journal_spilled->Add(l).Increment(spilled);
+
+	if (cache_journal_replayed != nullptr)
+		cache_journal_replayed->Add(l).Increment(replayed);
+}
+
+void PrometheusExporter::cache_fallback_finished(
+	const bool is_found,
+	const bool is_timeout,
+	const double time_consumed)
+{
+	std::lock_guard<std::mutex> lock{mutex_};
+
+	if (is_found) {
+		if (cache_fallback_hits != nullptr)
+			cache_fallback_hits->Add({}).Increment();
+	} else if (is_timeout) {
+		if (cache_fallback_timeouts != nullptr)
+			cache_fallback_timeouts->Add({}).Increment();
+	} else {
+		if (cache_fallback_misses != nullptr)
+			cache_fallback_misses->Add({}).Increment();
+	}
+
+	if (cache_fallback_time != nullptr)
+		cache_fallback_time->Add({}).Increment(time_consumed);
 }
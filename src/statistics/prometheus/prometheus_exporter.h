@@ -6,6 +6,7 @@
 #include <confuse.h>
 
 #include "prometheus/counter.h"
+#include "prometheus/gauge.h"
 #include "prometheus/exposer.h"
 #include "prometheus/family.h"
 #include "prometheus/registry.h"
@@ -35,6 +36,42 @@ public:
 		const string &type, CDriverCfg::CfgUniqId_t id,
 		const double time_consumed);
 
+	void driver_http_connection_increment(
+		const string &type, CDriverCfg::CfgUniqId_t id,
+		const bool is_reused);
+
+	void driver_http_probe_finished(
+		const string &type, CDriverCfg::CfgUniqId_t id,
+		const bool is_success, const double time_consumed);
+
+	void driver_index_loaded(
+		const string &type, CDriverCfg::CfgUniqId_t id,
+		const unsigned long generation, const size_t rows,
+		const size_t bytes, const double build_time);
+
+	void driver_ready_changed(
+		CDriverCfg::CfgUniqId_t id, const bool is_ready);
+
+	void driver_loaded(
+		CDriverCfg::CfgUniqId_t id, const double load_time);
+
+	void cache_batch_committed(
+		const unsigned int writer, const size_t entries, const bool is_success,
+		const double commit_time, const double lag);
+
+	void cache_queue_stats(
+		const unsigned int writer, const size_t depth, const unsigned long dropped);
+
+	void cache_entries_skipped(
+		const unsigned int writer, const size_t coalesced, const size_t unchanged);
+
+	void cache_fallback_finished(
+		const bool is_found, const bool is_timeout, const double time_consumed);
+
+	void cache_journal_stats(
+		const unsigned int writer, const size_t pending, const size_t segments,
+		const unsigned long spilled, const unsigned long replayed);
+
 	void driver_init_metrics(
 		const string &type,
 		CDriverCfg::CfgUniqId_t id);
@@ -49,6 +86,35 @@ private:
 	Family<Counter>* driver_requests_failed;
 	Family<Counter>* driver_requests_finished;
 	Family<Counter>* driver_requests_time;
+	Family<Counter>* driver_http_connections_new;
+	Family<Counter>* driver_http_connections_reused;
+	Family<Counter>* driver_http_probes;
+	Family<Counter>* driver_http_probes_failed;
+	Family<Gauge>* driver_http_probe_time;
+	Family<Gauge>* driver_memory_usage;
+	Family<Gauge>* driver_index_generation;
+	Family<Gauge>* driver_index_rows;
+	Family<Gauge>* driver_index_build_time;
+	Family<Gauge>* driver_ready;
+	Family<Gauge>* driver_load_time;
+	Family<Counter>* cache_batches;
+	Family<Counter>* cache_entries;
+	Family<Counter>* cache_entries_failed;
+	Family<Counter>* cache_commit_time;
+	Family<Gauge>* cache_batch_size;
+	Family<Gauge>* cache_writer_lag;
+	Family<Gauge>* cache_queue_depth;
+	Family<Counter>* cache_queue_dropped;
+	Family<Counter>* cache_entries_coalesced;
+	Family<Counter>* cache_entries_unchanged;
+	Family<Gauge>* cache_journal_pending;
+	Family<Gauge>* cache_journal_segments;
+	Family<Counter>* cache_journal_spilled;
+	Family<Counter>* cache_journal_replayed;
+	Family<Counter>* cache_fallback_hits;
+	Family<Counter>* cache_fallback_misses;
+	Family<Counter>* cache_fallback_timeouts;
+	Family<Counter>* cache_fallback_time;
 };
 
 extern int label_func(cfg_t *cfg, cfg_opt_t *opt, int argc, const char **argv);
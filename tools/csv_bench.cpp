@@ -0,0 +1,103 @@
+/*
+ * Measures 'MHASH/CSV' driver index lookups rate:
+ * one by one perform() calls versus performBatch()
+ *
+ * Numbers to lookup are sampled from the CSV file and shuffled,
+ * so the rate depends on the memory latency for the indexes
+ * larger than the last level cache
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <algorithm>
+
+#include "drivers/modules/CsvClient.h"
+
+// the same fields layout as CMhashCsvDriver uses with 'prefix_match'
+static const CCsvClient::SLayout_t csvLayout = { 0, 1, 2, 3, true };
+
+static const size_t defaultLookups = 4000000;
+static const size_t defaultBatch   = 32;
+
+static double elapsedSince(std::chrono::steady_clock::time_point start)
+{
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count();
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc < 2 || argc > 4) {
+		fprintf(stderr, "usage: %s <input.csv> [lookups=%zu] [batch=%zu]\n",
+			argv[0], defaultLookups, defaultBatch);
+		return EXIT_FAILURE;
+	}
+
+	size_t lookupsCnt = (argc > 2) ? strtoul(argv[2], nullptr, 10) : defaultLookups;
+	size_t batchSize  = (argc > 3) ? strtoul(argv[3], nullptr, 10) : defaultBatch;
+	if(!lookupsCnt || !batchSize) {
+		fprintf(stderr, "lookups and batch must be positive\n");
+		return EXIT_FAILURE;
+	}
+
+	try {
+		CCsvClient index(argv[1], csvLayout);
+
+		// sample numbers from the file
+		vector<string> numbers;
+		std::ifstream in(argv[1]);
+		string line;
+		while(std::getline(in, line)) {
+			string number = line.substr(0, line.find(','));
+			if(!number.empty())
+				numbers.emplace_back(std::move(number));
+		}
+		if(numbers.empty()) {
+			fprintf(stderr, "no numbers in %s\n", argv[1]);
+			return EXIT_FAILURE;
+		}
+
+		std::mt19937_64 rng(42);
+		vector<const string *> keys(lookupsCnt);
+		std::uniform_int_distribution<size_t> pick(0, numbers.size() - 1);
+		for(auto &k : keys)
+			k = &numbers[pick(rng)];
+
+		printf("%s: %zu rows, %zu bytes index, %zu lookups\n",
+			argv[1], index.size(), index.memoryUsage(), lookupsCnt);
+
+		// one by one
+		string rn, tag;
+		size_t found = 0;
+		auto start = std::chrono::steady_clock::now();
+		for(auto k : keys)
+			found += index.perform(*k, rn, tag);
+		double single = elapsedSince(start);
+		printf("single: %.0f lookups/s (%zu found)\n", lookupsCnt / single, found);
+
+		// batched
+		vector<string> rns(batchSize), tags(batchSize);
+		vector<CCsvClient::SLookup_t> batch(batchSize);
+		found = 0;
+		start = std::chrono::steady_clock::now();
+		for(size_t first = 0; first < lookupsCnt; first += batchSize) {
+			size_t cnt = std::min(batchSize, lookupsCnt - first);
+			for(size_t i = 0; i < cnt; i++)
+				batch[i] = { keys[first + i], &rns[i], &tags[i], false };
+			index.performBatch(batch.data(), cnt);
+			for(size_t i = 0; i < cnt; i++)
+				found += batch[i].isFound;
+		}
+		double batched = elapsedSince(start);
+		printf("batch of %zu: %.0f lookups/s (%zu found), x%.2f\n",
+			batchSize, lookupsCnt / batched, found, single / batched);
+	} catch(std::exception &e) {
+		fprintf(stderr, "error: %s\n", e.what());
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,304 @@
+/*
+ * Checks 'MHASH/CSV' driver index lookups on the corner case rows:
+ * both for the CSV file and its snapshot, by perform() and by
+ * performBatch() calls. Snapshots with corrupted tables and deltas
+ * with prefix rows must be rejected on loading. Without the prefix
+ * match '*' rows are the plain numbers
+ *
+ * Returns non-zero exit code on the first mismatch
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <string.h>
+#include <fstream>
+#include <iterator>
+#include <functional>
+
+#include "drivers/modules/CsvClient.h"
+#include "drivers/modules/CsvDelta.h"
+
+// the same fields layout as CMhashCsvDriver uses with 'prefix_match'
+static const CCsvClient::SLayout_t csvLayout = { 0, 1, 2, 3, true };
+static const CCsvClient::SLayout_t exactLayout = { 0, 1, 2, 3, false };
+
+static const char csvRows[] =
+	// packable number, not packable routing number
+	"12345,att,+15550001\n"
+	"2015551234,vz,12345678901234567\n"
+	// first occurrence wins between packed and raw rows
+	"2015550000,first,+15550000\n"
+	"2015550000,second,2015559999\n"
+	"2015550001,first,2015559999\n"
+	"2015550001,second,+15550001\n"
+	// not packable number
+	"+2015550002,raw,2015550002\n"
+	"201555*,prefix,2010000000\n"
+	// not packable prefixes are skipped
+	"20155*,skipped,12345678901234567\n"
+	"+20*,skipped,2010000000\n";
+
+struct SCase_t {
+	const char *number;
+	bool found;
+	const char *routingNumber;
+	const char *routingTag;
+};
+
+static const SCase_t cases[] = {
+	{ "12345", true, "+15550001", "att" },
+	{ "2015551234", true, "12345678901234567", "vz" },
+	{ "2015550000", true, "+15550000", "first" },
+	{ "2015550001", true, "2015559999", "first" },
+	{ "+2015550002", true, "2015550002", "raw" },
+	{ "2015557777", true, "2010000000", "prefix" },
+	{ "2025550000", false, "", "" },
+};
+
+static const size_t casesCnt = sizeof(cases) / sizeof(cases[0]);
+
+// performPrefix() ignores the number own row
+static const SCase_t prefixCases[] = {
+	{ "2015551234", true, "2010000000", "prefix" },
+	{ "2015557777", true, "2010000000", "prefix" },
+	{ "2015567777", false, "", "" },
+	{ "+2015550002", false, "", "" },
+	{ "2025550000", false, "", "" },
+};
+
+// without the prefix match, '*' rows are compiled to the snapshot
+// as prefixes, so only the first cases are checked for it
+static const size_t exactSnapshotCasesCnt = 2;
+static const SCase_t exactCases[] = {
+	{ "2015551234", true, "12345678901234567", "vz" },
+	{ "2015557777", false, "", "" },
+	{ "201555*", true, "2010000000", "prefix" },
+	{ "20155*", true, "12345678901234567", "skipped" },
+};
+
+static const size_t exactCasesCnt = sizeof(exactCases) / sizeof(exactCases[0]);
+
+static const char * const badDeltas[] = {
+	"2015551234,vz,2019999999\n201555*,prefix,2010000001\n",
+	"-201555*\n",
+};
+static const size_t fillerRows = 64;
+
+// the snapshot header start, as CCsvClient saves it
+struct SSnapshotHeader_t {
+	char magic[8];
+	uint32_t byteOrder;
+	uint32_t version;
+	uint32_t headerSize;
+	uint32_t bucketBits;
+	uint64_t entriesCnt;
+	uint64_t entriesOffset;
+	uint64_t bucketsOffset;
+};
+
+using Corruption_t = std::function<void (string &data, const SSnapshotHeader_t &hdr)>;
+
+static void setBucket(string &data, const SSnapshotHeader_t &hdr, size_t bucket, uint32_t offset)
+{
+	memcpy(&data[hdr.bucketsOffset + bucket * sizeof(offset)], &offset, sizeof(offset));
+}
+
+static const struct {
+	const char *name;
+	Corruption_t corrupt;
+} corruptions[] = {
+	{ "bucket offset above entries", [](string &data, const SSnapshotHeader_t &hdr) {
+		setBucket(data, hdr, 1, hdr.entriesCnt + 1);
+	} },
+	{ "descending bucket offsets", [](string &data, const SSnapshotHeader_t &hdr) {
+		setBucket(data, hdr, 1, hdr.entriesCnt);
+		setBucket(data, hdr, 2, 0);
+	} },
+	{ "entry tag out of tags", [](string &data, const SSnapshotHeader_t &hdr) {
+		// tag id high bits are above the packed number
+		data[hdr.entriesOffset + sizeof(uint64_t) - 1] = '\xFF';
+	} },
+};
+
+static bool checkCorrupted(const string &snapshotPath)
+{
+	string snapshot;
+	{
+		std::ifstream in(snapshotPath, std::ios::binary);
+		snapshot.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	}
+
+	SSnapshotHeader_t hdr;
+	memcpy(&hdr, snapshot.data(), sizeof(hdr));
+	if(hdr.bucketBits < 2 || hdr.entriesCnt < 2) {
+		fprintf(stderr, "snapshot is too small for corruption checks\n");
+		return false;
+	}
+
+	bool rv = true;
+	string corruptedPath = snapshotPath + ".corrupted";
+	for(const auto &c : corruptions) {
+		string data = snapshot;
+		c.corrupt(data, hdr);
+		std::ofstream(corruptedPath, std::ios::binary) << data;
+
+		try {
+			CCsvClient index(corruptedPath.c_str(), csvLayout);
+			fprintf(stderr, "snapshot with %s is loaded\n", c.name);
+			rv = false;
+		} catch(CCsvClient::error &) {
+			// expected
+		}
+	}
+	unlink(corruptedPath.c_str());
+
+	return rv;
+}
+
+static bool check(const char *name, const SCase_t &c, bool found,
+	const string &routingNumber, const string &routingTag)
+{
+	if(found == c.found &&
+		(!found || (routingNumber == c.routingNumber && routingTag == c.routingTag)))
+		return true;
+
+	fprintf(stderr, "%s: '%s' is %s '%s'/'%s', expected %s '%s'/'%s'\n",
+		name, c.number,
+		found ? "found" : "not found", routingNumber.c_str(), routingTag.c_str(),
+		c.found ? "found" : "not found", c.routingNumber, c.routingTag);
+	return false;
+}
+
+static bool checkIndex(const char *name, const CCsvClient &index)
+{
+	bool rv = true;
+
+	for(const auto &c : cases) {
+		string rn, tag;
+		bool found = index.perform(c.number, rn, tag);
+		rv &= check(name, c, found, rn, tag);
+	}
+
+	vector<string> numbers(casesCnt), rns(casesCnt), tags(casesCnt);
+	vector<CCsvClient::SLookup_t> batch(casesCnt);
+	for(size_t i = 0; i < casesCnt; i++) {
+		numbers[i] = cases[i].number;
+		batch[i] = { &numbers[i], &rns[i], &tags[i], false };
+	}
+	index.performBatch(batch.data(), casesCnt);
+	for(size_t i = 0; i < casesCnt; i++)
+		rv &= check(name, cases[i], batch[i].isFound, rns[i], tags[i]);
+
+	for(const auto &c : prefixCases) {
+		string rn, tag;
+		bool found = index.performPrefix(c.number, rn, tag);
+		rv &= check(name, c, found, rn, tag);
+	}
+
+	return rv;
+}
+
+static bool checkExact(const char *name, const CCsvClient &index, size_t count)
+{
+	bool rv = true;
+
+	if(index.prefixesCount()) {
+		fprintf(stderr, "%s: %zu prefixes without the prefix match\n", name, index.prefixesCount());
+		rv = false;
+	}
+
+	for(size_t i = 0; i < count; i++) {
+		string rn, tag;
+		bool found = index.perform(exactCases[i].number, rn, tag);
+		rv &= check(name, exactCases[i], found, rn, tag);
+	}
+
+	return rv;
+}
+
+static bool checkDeltas(const string &deltaPath)
+{
+	bool rv = true;
+
+	for(const auto &d : badDeltas) {
+		std::ofstream(deltaPath) << d;
+		try {
+			CCsvDelta delta(deltaPath.c_str(), csvLayout);
+			fprintf(stderr, "delta with prefix row is loaded\n");
+			rv = false;
+		} catch(CCsvDelta::error &) {
+			// expected
+		}
+	}
+
+	// '*' is the part of the number without the prefix match
+	std::ofstream(deltaPath) << badDeltas[0];
+	try {
+		CCsvDelta delta(deltaPath.c_str(), exactLayout);
+		string rn, tag;
+		if(CCsvDelta::EDELTA_FOUND != delta.perform("201555*", rn, tag)) {
+			fprintf(stderr, "delta '*' row is not found without the prefix match\n");
+			rv = false;
+		}
+	} catch(CCsvDelta::error &e) {
+		fprintf(stderr, "delta without the prefix match: %s\n", e.what());
+		rv = false;
+	}
+	unlink(deltaPath.c_str());
+
+	return rv;
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc != 2) {
+		fprintf(stderr, "usage: %s <work dir>\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	string csvPath = string(argv[1]) + "/csv_check.csv";
+	string snapshotPath = string(argv[1]) + "/csv_check.snapshot";
+	bool ok = true;
+
+	try {
+		{
+			std::ofstream csv(csvPath);
+			csv << csvRows;
+			// enough rows for several buckets of the snapshot
+			for(size_t i = 0; i < fillerRows; i++)
+				csv << 3015550000 + i << ",filler," << 3015560000 + i << '\n';
+		}
+
+		CCsvClient index(csvPath.c_str(), csvLayout);
+		ok &= checkIndex("csv", index);
+
+		index.save(snapshotPath.c_str());
+		CCsvClient snapshot(snapshotPath.c_str(), csvLayout);
+		if(!snapshot.isSnapshot()) {
+			fprintf(stderr, "%s is not loaded as snapshot\n", snapshotPath.c_str());
+			ok = false;
+		}
+		ok &= checkIndex("snapshot", snapshot);
+		ok &= checkExact("csv exact", CCsvClient(csvPath.c_str(), exactLayout), exactCasesCnt);
+		ok &= checkExact("snapshot exact", CCsvClient(snapshotPath.c_str(), exactLayout),
+			exactSnapshotCasesCnt);
+		ok &= checkCorrupted(snapshotPath);
+		ok &= checkDeltas(csvPath + ".delta");
+	} catch(std::exception &e) {
+		fprintf(stderr, "error: %s\n", e.what());
+		ok = false;
+	}
+
+	unlink(csvPath.c_str());
+	unlink(snapshotPath.c_str());
+
+	if(!ok)
+		return EXIT_FAILURE;
+
+	printf("%zu lookups, %zu corrupted snapshots, %zu deltas are checked\n",
+		casesCnt + sizeof(prefixCases) / sizeof(prefixCases[0]) + exactCasesCnt,
+		sizeof(corruptions) / sizeof(corruptions[0]),
+		sizeof(badDeltas) / sizeof(badDeltas[0]));
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,47 @@
+/*
+ * Compiles ported numbers CSV file to the binary snapshot
+ * used by 'MHASH/CSV' driver without parsing on startup
+ *
+ * CSV file format: number,routing tag,routing number
+ * (number ending by '*' is compiled as the prefix, it is used
+ * by the driver with 'prefix_match' parameter only)
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <chrono>
+
+#include "drivers/modules/CsvClient.h"
+
+// the same fields layout as CMhashCsvDriver uses with 'prefix_match'
+static const CCsvClient::SLayout_t csvLayout = { 0, 1, 2, 3, true };
+
+int main(int argc, char *argv[])
+{
+	if(argc != 3) {
+		fprintf(stderr, "usage: %s <input.csv> <output.snapshot>\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	try {
+		auto start = std::chrono::steady_clock::now();
+
+		CCsvClient index(argv[1], csvLayout);
+		if(index.isSnapshot()) {
+			fprintf(stderr, "%s is already compiled\n", argv[1]);
+			return EXIT_FAILURE;
+		}
+
+		index.save(argv[2]);
+
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		printf("%s: %zu rows, %zu prefixes, %zu tags, %zu bytes index, %.3f seconds\n",
+			argv[2], index.size(), index.prefixesCount(), index.tagsCount(), index.memoryUsage(),
+			elapsed.count());
+	} catch(std::exception &e) {
+		fprintf(stderr, "error: %s\n", e.what());
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
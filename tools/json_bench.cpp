@@ -0,0 +1,272 @@
+/*
+ * Measures HTTP drivers reply parsing rate:
+ * JsonView in place extraction versus cJSON/jsonxx trees
+ * used by the drivers before
+ *
+ * Replies are the providers samples from the drivers,
+ * fields are extracted the same way as the drivers do.
+ * CoureAnq bulk reply items matching with the requests numbers
+ * is checked before the measurements
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+
+#include "drivers/JsonView.h"
+#include "drivers/JsonHelpers.h"
+#include "drivers/modules/NumberFormat.h"
+#include "libs/jsonxx.h"
+#include "libs/cJSON.h"
+
+using std::string;
+using std::vector;
+
+static const size_t defaultIterations = 1000000;
+static const char coureAnqCountryCode[] = "234";
+static const size_t bulkItems = 32;
+
+static const string thinqReply =
+	"{\"lrn\":\"9198900000\",\"lerg\":{\"npa\":\"919\",\"nxx\":\"287\",\"y\":\"A\","
+	"\"lata\":\"426\",\"ocn\":\"7555\",\"company\":\"TW TELECOM OF NC\","
+	"\"rc\":\"DURHAM\",\"state\":\"NC\"}}";
+
+static const string alcazarReply =
+	"{\"LRN\":\"14847880088\",\"SPID\":\"7513\",\"OCN\":\"7513\",\"LATA\":\"228\","
+	"\"CITY\":\"ALLENTOWN\",\"STATE\":\"PA\",\"JURISDICTION\":\"INDETERMINATE\","
+	"\"LEC\":\"CTSI, INC. - PA\",\"LINETYPE\":\"LANDLINE\"}";
+
+static const string bulkvsReply =
+	"{\"name\":\"BULK SOLUTIONS\",\"number\":\"3109060901\",\"time\":1680002903}";
+
+static const string coureAnqItem =
+	"{\"CountryCode\":\"235\",\"IsPorted\":1,\"Number\":\"2347068970633\","
+	"\"OperatorMobileNumberCode\":\"49\",\"TheOperator\":\"ETS\","
+	"\"UniversalNumberFormat\":\"2347068970633\"}";
+
+struct SResult_t {
+	string lrn, tag, raw;
+};
+
+using Parser_t = std::function<void (const string &data, SResult_t &r)>;
+
+static double elapsedSince(std::chrono::steady_clock::time_point start)
+{
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count();
+}
+
+static double measure(const string &data, const Parser_t &parse, size_t iterations)
+{
+	SResult_t r;
+	auto start = std::chrono::steady_clock::now();
+	for(size_t i = 0; i < iterations; i++)
+		parse(data, r);
+	return elapsedSince(start);
+}
+
+/* the previous drivers parsers */
+
+static void thinqTree(const string &data, SResult_t &r)
+{
+	r.lrn = static_cast<string>(jsonxx(data)["lrn"]);
+	r.raw = data;
+}
+
+static void alcazarTree(const string &data, SResult_t &r)
+{
+	jsonxx j{data};
+	r.lrn = static_cast<string>(j["LRN"]);
+	r.tag = static_cast<string>(j["JURISDICTION"]);
+	r.raw = data;
+}
+
+static void bulkvsTree(const string &data, SResult_t &r)
+{
+	r.lrn = static_cast<string>(jsonxx(data)["name"]);
+	r.raw = data;
+}
+
+static void coureAnqItemTree(cJSON &item, SResult_t &r)
+{
+	if(getJsonValueByKey<int>(item, "IsPorted") == 1) {
+		r.lrn = getJsonValueByKey<string>(item, "Number");
+		r.tag = getJsonValueByKey<string>(item, "TheOperator");
+	}
+}
+
+static void coureAnqTree(const string &data, SResult_t &r)
+{
+	std::unique_ptr<cJSON, void(*)(cJSON*)> j(cJSON_Parse(data.data()), cJSON_Delete);
+	if(!j) throw std::runtime_error("failed to parse reply JSON");
+	coureAnqItemTree(*cJSON_GetObjectItem(j.get(), "Result")->child, r);
+	r.raw = data;
+}
+
+static void coureAnqBulkTree(const string &data, SResult_t &r)
+{
+	std::unique_ptr<cJSON, void(*)(cJSON*)> j(cJSON_Parse(data.data()), cJSON_Delete);
+	if(!j) throw std::runtime_error("failed to parse reply JSON");
+	for(cJSON *item = cJSON_GetObjectItem(j.get(), "Result")->child; item; item = item->next) {
+		coureAnqItemTree(*item, r);
+		char *s = cJSON_PrintUnformatted(item);
+		r.raw = s;
+		free(s);
+	}
+}
+
+/* JsonView parsers as the drivers use now */
+
+static void thinqView(const string &data, SResult_t &r)
+{
+	JsonView lrn;
+	if(!JsonView(data).extract({ { "lrn", &lrn } }))
+		throw std::runtime_error("no 'lrn' value in reply");
+	lrn.getString(r.lrn, true);
+	r.raw = data;
+}
+
+static void alcazarView(const string &data, SResult_t &r)
+{
+	JsonView lrn, jurisdiction;
+	if(2 != JsonView(data).extract({ { "LRN", &lrn }, { "JURISDICTION", &jurisdiction } }))
+		throw std::runtime_error("no 'LRN' or 'JURISDICTION' value in reply");
+	lrn.getString(r.lrn, true);
+	jurisdiction.getString(r.tag, true);
+	r.raw = data;
+}
+
+static void bulkvsView(const string &data, SResult_t &r)
+{
+	JsonView name;
+	if(!JsonView(data).extract({ { "name", &name } }))
+		throw std::runtime_error("no 'name' value in reply");
+	name.getString(r.lrn, true);
+	r.raw = data;
+}
+
+static void coureAnqItemView(const JsonView &item, SResult_t &r)
+{
+	JsonView ported, number, op;
+	item.extract({ { "IsPorted", &ported }, { "Number", &number }, { "TheOperator", &op } });
+	long v;
+	if(ported.getInt(v) && v == 1) {
+		number.getString(r.lrn, true);
+		op.getString(r.tag, true);
+	}
+}
+
+static void coureAnqView(const string &data, SResult_t &r)
+{
+	JsonView j(data);
+	if(!j.isValid()) throw std::runtime_error("failed to parse reply JSON");
+	coureAnqItemView(j.get("Result").front(), r);
+	r.raw = data;
+}
+
+static void coureAnqBulkView(const string &data, SResult_t &r)
+{
+	JsonView j(data);
+	if(!j.isValid()) throw std::runtime_error("failed to parse reply JSON");
+	JsonView result = j.get("Result");
+	for(JsonView item = result.front(); item.isValid(); item = result.next(item)) {
+		coureAnqItemView(item, r);
+		r.raw.assign(item.raw().data(), item.raw().size());
+	}
+}
+
+/* requests numbers formats matching the international reply number */
+static bool checkCoureAnqMatching()
+{
+	static const char *const requests[] = {
+		"07068970633", "2347068970633", "+2347068970633", "002347068970633", "7068970633"
+	};
+
+	JsonView number;
+	JsonView(coureAnqItem).extract({ { "Number", &number } });
+	string reply = national_number(number.raw(), coureAnqCountryCode);
+
+	bool rv = true;
+	for(const char *r : requests) {
+		if(national_number(r, coureAnqCountryCode) != reply) {
+			fprintf(stderr, "coureanq: request '%s' does not match reply number '%.*s'\n",
+				r, static_cast<int>(number.raw().size()), number.raw().data());
+			rv = false;
+		}
+	}
+	if(national_number("07068970634", coureAnqCountryCode) == reply) {
+		fprintf(stderr, "coureanq: another number matches reply number\n");
+		rv = false;
+	}
+	return rv;
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc > 2) {
+		fprintf(stderr, "usage: %s [iterations=%zu]\n", argv[0], defaultIterations);
+		return EXIT_FAILURE;
+	}
+
+	size_t iterations = (argc > 1) ? strtoul(argv[1], nullptr, 10) : defaultIterations;
+	if(!iterations) {
+		fprintf(stderr, "iterations must be positive\n");
+		return EXIT_FAILURE;
+	}
+
+	if(!checkCoureAnqMatching())
+		return EXIT_FAILURE;
+
+	string coureAnqReply = "{\"Result\":[" + coureAnqItem + "]}";
+	string coureAnqBulkReply = "{\"Result\":[";
+	for(size_t i = 0; i < bulkItems; i++) {
+		if(i) coureAnqBulkReply += ',';
+		coureAnqBulkReply += coureAnqItem;
+	}
+	coureAnqBulkReply += "]}";
+
+	struct SCase_t {
+		const char *name;
+		const string &data;
+		Parser_t tree, view;
+		size_t iterations;
+	};
+	const vector<SCase_t> cases = {
+		{ "thinq", thinqReply, thinqTree, thinqView, iterations },
+		{ "alcazar", alcazarReply, alcazarTree, alcazarView, iterations },
+		{ "bulkvs", bulkvsReply, bulkvsTree, bulkvsView, iterations },
+		{ "coureanq", coureAnqReply, coureAnqTree, coureAnqView, iterations },
+		{ "coureanq bulk", coureAnqBulkReply, coureAnqBulkTree, coureAnqBulkView,
+			std::max(iterations / bulkItems, size_t(1)) },
+	};
+
+	try {
+		for(const auto &c : cases) {
+			// results must be the same
+			SResult_t tree, view;
+			c.tree(c.data, tree);
+			c.view(c.data, view);
+			if(tree.lrn != view.lrn || tree.tag != view.tag) {
+				fprintf(stderr, "%s: results differ: '%s'/'%s' vs '%s'/'%s'\n", c.name,
+					tree.lrn.c_str(), tree.tag.c_str(), view.lrn.c_str(), view.tag.c_str());
+				return EXIT_FAILURE;
+			}
+
+			double treeTime = measure(c.data, c.tree, c.iterations);
+			double viewTime = measure(c.data, c.view, c.iterations);
+			printf("%-14s %4zu bytes: cJSON %7.0f ns, JsonView %7.0f ns per reply, x%.2f\n",
+				c.name, c.data.size(),
+				treeTime * 1e9 / c.iterations, viewTime * 1e9 / c.iterations,
+				treeTime / viewTime);
+		}
+	} catch(std::exception &e) {
+		fprintf(stderr, "error: %s\n", e.what());
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}